@@ -0,0 +1,54 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Software mixer running inside the SDL audio callback. The game thread
+// never takes the device lock: every call below posts a command into a
+// lock-free queue that the callback drains at the start of each buffer.
+// All Audio_* calls on a mixer must come from one thread.
+
+typedef struct Audio_Mixer Audio_Mixer;
+typedef struct Audio_Sound Audio_Sound;
+
+// 0 is never a valid handle. Handles of finished voices go stale and
+// commands sent to them are ignored.
+typedef uint32_t Audio_Voice;
+
+typedef struct {
+  int frequency;     // Output rate in Hz, 0 for 48000
+  int buffer_frames; // Frames per callback; smaller means lower latency, 0 for 512
+  int max_voices;    // 0 for 64
+} Audio_Config;
+
+// Opens the default device of the initialized audio subsystem. config may
+// be NULL for the defaults.
+Audio_Mixer* Audio_Create(const Audio_Config* config);
+void Audio_Destroy(Audio_Mixer* mixer);
+
+// Sounds are decoded up front and kept as float planes. A sound must outlive
+// every voice playing it.
+Audio_Sound* Audio_LoadSound(const char* wav_path);
+Audio_Sound* Audio_CreateSound(const float* samples, int frames, int channels, int frequency); // Interleaved input
+void Audio_DestroySound(Audio_Sound* sound);
+
+// volume is linear, pan runs from -1 (left) to 1 (right) and pitch scales
+// the playback rate on top of resampling to the device rate.
+Audio_Voice Audio_Play(Audio_Mixer* mixer, const Audio_Sound* sound, float volume, float pan, float pitch, bool loop);
+// Long tracks are decoded incrementally on the mixer's decoder thread.
+Audio_Voice Audio_PlayStream(Audio_Mixer* mixer, const char* wav_path, float volume, bool loop);
+
+// Changes glide linearly over ramp_ms, which also avoids clicks at 0.
+void Audio_SetVolume(Audio_Mixer* mixer, Audio_Voice voice, float volume, float ramp_ms);
+void Audio_SetPan(Audio_Mixer* mixer, Audio_Voice voice, float pan, float ramp_ms);
+void Audio_Stop(Audio_Mixer* mixer, Audio_Voice voice, float fade_ms);
+
+// Reclaims voices the callback finished. Call once per frame.
+void Audio_Update(Audio_Mixer* mixer);
+int Audio_GetActiveVoices(const Audio_Mixer* mixer);
+int Audio_GetBufferFrames(const Audio_Mixer* mixer);
+
+void Audio_Benchmark(void);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef CORO_H
+#define CORO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include <engine/jobs/jobs.h>
+#include <engine/timer/timer.h>
+
+// Stackful coroutines for game logic that spans frames. A scheduler belongs
+// to the thread that calls Coro_RunFrame; coroutines only ever run inside
+// that call, one at a time, so they need no locking between each other.
+// Stacks are pooled and sit above a guard page, so an overflow faults
+// instead of corrupting a neighbour. Every guard costs a kernel mapping;
+// once vm.max_map_count is reached further stacks are unguarded, which the
+// coro_stacks_unguarded gauge shows.
+
+typedef struct Coro_Scheduler Coro_Scheduler;
+
+typedef void (*Coro_Function)(void* data);
+
+// Completion flag for work finished outside the scheduler, such as async I/O.
+// Zero-initialize; Coro_Signal is safe from any thread.
+typedef struct {
+  atomic_int signaled;
+} Coro_Event;
+
+// stack_size of 0 picks the default. It is rounded up to whole pages and
+// excludes the guard page.
+Coro_Scheduler* Coro_CreateScheduler(size_t stack_size);
+// Coroutines still suspended are dropped without being resumed. Jobs that
+// coroutines wait on through Coro_WaitJobs or Coro_RunBlocking are waited
+// for first, so the job pool must still be running.
+void Coro_DestroyScheduler(Coro_Scheduler* scheduler);
+
+// The coroutine first runs on the next Coro_RunFrame, or later in the current
+// one when spawned from a coroutine.
+bool Coro_Spawn(Coro_Scheduler* scheduler, Coro_Function function, void* data);
+// Resumes every coroutine whose awaitable is ready.
+void Coro_RunFrame(Coro_Scheduler* scheduler);
+int Coro_GetLiveCount(const Coro_Scheduler* scheduler);
+// How long the caller may sleep before Coro_RunFrame has work: 0 when a
+// coroutine is runnable, short while some poll for jobs or events.
+int Coro_NextWakeIn(const Coro_Scheduler* scheduler, int max_ms);
+// True while a coroutine waits in Coro_NextFrame. Such coroutines only make
+// progress when frames are drawn, so the loop should treat this as a redraw.
+bool Coro_WantsFrame(const Coro_Scheduler* scheduler);
+
+// Awaitables. These suspend the calling coroutine and must be called from one.
+void Coro_NextFrame(void);
+void Coro_WaitTimer(Timer_Wheel* wheel, uint64_t delay_ms);
+void Coro_WaitJobs(Jobs_Counter* counter);
+void Coro_WaitEvent(Coro_Event* event);
+// Runs a blocking function (file or socket I/O) on a job worker and resumes
+// once it returned. data often lives on the coroutine's stack, which is
+// unmapped with the scheduler, so the job must not keep it past its return.
+void Coro_RunBlocking(Jobs_Function function, void* data);
+
+void Coro_Signal(Coro_Event* event);
+void Coro_ResetEvent(Coro_Event* event);
+bool Coro_IsSignaled(Coro_Event* event);
+
+bool Coro_InCoroutine(void);
+
+void Coro_Benchmark(void);
+
+#endif
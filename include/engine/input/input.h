@@ -0,0 +1,84 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Folds the frame's SDL events into one snapshot, so systems read plain
+// state instead of handling events. Key indices are SDL scancodes and
+// buttons are SDL button numbers (SDL_BUTTON_LEFT is 1).
+
+#define INPUT_KEY_COUNT 512
+#define INPUT_KEY_WORDS (INPUT_KEY_COUNT / 64)
+#define INPUT_TEXT_SIZE 128
+
+typedef struct {
+  uint64_t keys_down[INPUT_KEY_WORDS];
+  uint64_t keys_pressed[INPUT_KEY_WORDS];  // Went down this frame
+  uint64_t keys_released[INPUT_KEY_WORDS]; // Went up this frame
+  uint32_t buttons_down;
+  uint32_t buttons_pressed;
+  uint32_t buttons_released;
+
+  int mouse_x, mouse_y;   // Latest position in window coordinates
+  int mouse_dx, mouse_dy; // Accumulated over the frame
+  int wheel_x, wheel_y;   // Accumulated, positive is away from the user
+
+  char text[INPUT_TEXT_SIZE]; // UTF-8 typed this frame, NUL-terminated
+  int text_length;
+
+  bool quit_requested;
+  bool window_changed; // Resize, expose or lost render targets
+  bool device_reset;   // Every texture was lost and must be recreated
+
+  int event_count;
+  uint64_t oldest_input; // Performance counter of the frame's first input event, 0 if none
+} Input_Snapshot;
+
+// Over the last INPUT_LATENCY_SAMPLES frames that presented fresh input.
+typedef struct {
+  int samples;
+  double p50_ms;
+  double p95_ms;
+  double p99_ms;
+  double max_ms;
+} Input_LatencyStats;
+
+typedef struct Input_State Input_State;
+
+Input_State* Input_Create(void);
+void Input_Destroy(Input_State* input);
+
+// Drains every queued event and returns the new snapshot.
+const Input_Snapshot* Input_Poll(Input_State* input);
+const Input_Snapshot* Input_GetSnapshot(const Input_State* input);
+
+// Call right after the present that shows this frame's input.
+void Input_MarkPresented(Input_State* input);
+Input_LatencyStats Input_GetLatency(const Input_State* input);
+
+static inline bool Input_IsKeyDown(const Input_Snapshot* snapshot, int scancode) {
+  return (unsigned)scancode < INPUT_KEY_COUNT && (snapshot->keys_down[scancode >> 6] >> (scancode & 63)) & 1;
+}
+
+static inline bool Input_WasKeyPressed(const Input_Snapshot* snapshot, int scancode) {
+  return (unsigned)scancode < INPUT_KEY_COUNT && (snapshot->keys_pressed[scancode >> 6] >> (scancode & 63)) & 1;
+}
+
+static inline bool Input_WasKeyReleased(const Input_Snapshot* snapshot, int scancode) {
+  return (unsigned)scancode < INPUT_KEY_COUNT && (snapshot->keys_released[scancode >> 6] >> (scancode & 63)) & 1;
+}
+
+static inline bool Input_IsButtonDown(const Input_Snapshot* snapshot, int button) {
+  return button >= 1 && button <= 32 && (snapshot->buttons_down >> (button - 1)) & 1;
+}
+
+static inline bool Input_WasButtonPressed(const Input_Snapshot* snapshot, int button) {
+  return button >= 1 && button <= 32 && (snapshot->buttons_pressed >> (button - 1)) & 1;
+}
+
+static inline bool Input_WasButtonReleased(const Input_Snapshot* snapshot, int button) {
+  return button >= 1 && button <= 32 && (snapshot->buttons_released >> (button - 1)) & 1;
+}
+
+#endif
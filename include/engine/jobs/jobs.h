@@ -0,0 +1,30 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+typedef void (*Jobs_Function)(void* data);
+typedef void (*Jobs_RangeFunction)(int begin, int end, void* data);
+
+// Tracks outstanding jobs. Zero-initialize, pass to Jobs_Submit, then wait on it.
+typedef struct {
+  atomic_int pending;
+} Jobs_Counter;
+
+// Worker pool setup and teardown. The pool is lazily started on first use with
+// one worker per extra CPU, so Jobs_Init is only needed to pick a count; call
+// it before any other Jobs_* call. Returns false when the pool is already
+// running with a different count. A worker_count of 0 picks the default.
+bool Jobs_Init(int worker_count);
+void Jobs_Destroy(void);
+int Jobs_GetWorkerCount(void);
+
+void Jobs_Submit(Jobs_Function function, void* data, Jobs_Counter* counter);
+bool Jobs_IsDone(Jobs_Counter* counter);
+void Jobs_Wait(Jobs_Counter* counter); // Runs queued jobs on the caller while waiting
+
+// Splits [0, count) into batches of at least min_batch and blocks until all ran.
+void Jobs_ParallelFor(int count, int min_batch, Jobs_RangeFunction function, void* data);
+
+#endif
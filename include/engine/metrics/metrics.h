@@ -0,0 +1,46 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Named counters, gauges and fixed-bucket histograms. Updates go to per-thread
+// shards of relaxed atomics, so hot paths never contend; reads sum the shards.
+// Registering an existing name of the same kind returns the same handle, and
+// handles stay valid for the life of the process.
+
+#define METRICS_MAX_BUCKETS 16
+
+typedef struct Metrics_Counter Metrics_Counter;
+typedef struct Metrics_Gauge Metrics_Gauge;
+typedef struct Metrics_Histogram Metrics_Histogram;
+
+Metrics_Counter* Metrics_RegisterCounter(const char* name);
+Metrics_Gauge* Metrics_RegisterGauge(const char* name);
+// bounds are ascending upper bucket bounds; values above the last one land in +Inf.
+Metrics_Histogram* Metrics_RegisterHistogram(const char* name, const double* bounds, int bound_count);
+
+// All update functions accept NULL so callers need not check registration.
+void Metrics_CounterAdd(Metrics_Counter* counter, uint64_t amount);
+void Metrics_GaugeSet(Metrics_Gauge* gauge, int64_t value);
+void Metrics_GaugeAdd(Metrics_Gauge* gauge, int64_t delta);
+void Metrics_HistogramObserve(Metrics_Histogram* histogram, double value);
+
+uint64_t Metrics_CounterRead(const Metrics_Counter* counter);
+int64_t Metrics_GaugeRead(const Metrics_Gauge* gauge);
+// Sums every gauge whose name starts with prefix, e.g. "memory_".
+int64_t Metrics_SumGauges(const char* prefix);
+// counts_out receives bound_count + 1 cumulative-free bucket counts; returns the total count.
+uint64_t Metrics_HistogramRead(const Metrics_Histogram* histogram, uint64_t* counts_out, double* sum_out);
+
+// Writes every metric in the Prometheus text format. Returns the length the
+// full dump needs, like snprintf.
+size_t Metrics_Format(char* buffer, size_t size);
+
+// Serves Metrics_Format to every client connecting to a UNIX domain socket,
+// e.g. `nc -U <path>` or `socat - UNIX-CONNECT:<path>`.
+bool Metrics_StartServer(const char* socket_path);
+void Metrics_StopServer(void);
+
+#endif
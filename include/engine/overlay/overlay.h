@@ -0,0 +1,34 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Debug HUD drawn on top of the frame: a rolling frame-time graph, the
+// slowest profiler zones, draw calls, tracked memory and the logger queue
+// depth. Text comes from a built-in 5x7 font baked once into a glyph atlas,
+// so a visible overlay costs two SDL_RenderGeometry calls: one for panels
+// and bars, one for text. Hidden, it only records frame times.
+
+typedef struct Overlay Overlay;
+
+// Returns NULL if the atlas texture cannot be created; every call below
+// accepts NULL.
+Overlay* Overlay_Create(SDL_Renderer* renderer);
+void Overlay_Destroy(Overlay* overlay);
+
+void Overlay_SetVisible(Overlay* overlay, bool visible);
+void Overlay_Toggle(Overlay* overlay);
+bool Overlay_IsVisible(const Overlay* overlay);
+
+// Rebakes the glyph atlas after SDL_RENDER_DEVICE_RESET destroyed it.
+void Overlay_OnDeviceReset(Overlay* overlay);
+
+// Call once per presented frame, so the graph is already filled when shown.
+void Overlay_RecordFrame(Overlay* overlay, double frame_ms, int draw_calls);
+
+// Draws on the current render target. Returns the draw calls it issued,
+// 0 while hidden. Its own cost is profiled as the "overlay" zone.
+int Overlay_Draw(Overlay* overlay);
+
+#endif
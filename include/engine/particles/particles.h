@@ -0,0 +1,35 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Structure-of-arrays particle system. Each system owns one texture and is
+// drawn with a single SDL_RenderGeometry call.
+
+typedef struct Particle_System Particle_System;
+
+typedef struct {
+  float x, y;
+  float position_jitter; // Spawn offset in [-jitter, jitter] on each axis
+  float vx, vy;
+  float velocity_jitter;
+  float life_min, life_max; // Seconds
+  SDL_Color color;
+} Particle_Emitter;
+
+Particle_System* Particles_Create(int capacity, SDL_Texture* texture, float size);
+void Particles_Destroy(Particle_System* system);
+
+void Particles_SetGravity(Particle_System* system, float gx, float gy);
+void Particles_SetParallel(Particle_System* system, bool parallel);
+
+int Particles_Emit(Particle_System* system, const Particle_Emitter* emitter, int count); // Returns emitted count
+void Particles_Update(Particle_System* system, float dt);
+void Particles_Draw(Particle_System* system, SDL_Renderer* renderer);
+
+int Particles_GetCount(const Particle_System* system);
+
+void Particles_Benchmark(void);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Named timing zones summed per frame. Profiler_End may be called from any
+// thread; Profiler_EndFrame and the readers belong to the game thread.
+//
+//   uint64_t start = Profiler_Begin();
+//   ...
+//   Profiler_End(zone, start);
+
+#define PROFILER_MAX_ZONES 64
+#define PROFILER_NAME_SIZE 32
+
+typedef struct Profiler_Zone Profiler_Zone;
+
+typedef struct {
+  const char* name;
+  double last_ms;    // Total of the last finished frame
+  double average_ms; // Smoothed over recent frames
+  uint32_t calls;    // In the last finished frame
+} Profiler_ZoneStats;
+
+// Registering an existing name returns the same zone; zones live for the
+// life of the process. Returns NULL when the table is full.
+Profiler_Zone* Profiler_RegisterZone(const char* name);
+
+static inline uint64_t Profiler_Begin(void) {
+  return SDL_GetPerformanceCounter();
+}
+
+// Accepts NULL so callers need not check registration.
+void Profiler_End(Profiler_Zone* zone, uint64_t start);
+
+// Closes the frame: every zone's running total becomes its last frame time.
+void Profiler_EndFrame(void);
+
+// Fills out with up to max zones, slowest average first. Returns the count.
+int Profiler_GetTopZones(Profiler_ZoneStats* out, int max);
+
+#endif
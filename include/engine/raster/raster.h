@@ -0,0 +1,37 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Engine-side software sprite rasterizer for targets without a GPU renderer.
+// Draws are queued, binned into framebuffer tiles and rendered on Raster_Flush.
+// Framebuffers and sprites must be non-RLE SDL_PIXELFORMAT_ARGB8888 surfaces.
+
+typedef struct Raster Raster;
+
+typedef enum {
+  RASTER_KERNEL_SCALAR,
+  RASTER_KERNEL_SSE2,
+  RASTER_KERNEL_AVX2
+} Raster_Kernel;
+
+Raster* Raster_Create(SDL_Surface* framebuffer);
+void Raster_Destroy(Raster* raster);
+
+void Raster_SetParallel(Raster* raster, bool parallel);
+
+void Raster_Clear(Raster* raster, SDL_Color color);
+// SDL_BLENDMODE_NONE copies, every other mode alpha-blends. NULL src draws the
+// whole sprite, NULL dst draws it unscaled at (0, 0).
+void Raster_DrawSprite(Raster* raster, SDL_Surface* sprite, const SDL_Rect* src, const SDL_Rect* dst, SDL_Color tint, SDL_BlendMode mode);
+void Raster_Flush(Raster* raster);
+
+// Kernel selection is detected once from the CPU; forcing is for benchmarks.
+Raster_Kernel Raster_GetKernel(void);
+bool Raster_ForceKernel(Raster_Kernel kernel);
+const char* Raster_KernelName(Raster_Kernel kernel);
+
+void Raster_Benchmark(void);
+
+#endif
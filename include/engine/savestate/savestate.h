@@ -0,0 +1,56 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Binary save states made of raw memory sections. A save copies every
+// section into a staging buffer within the frame; hashing, compression and
+// the durable write (temporary file, fsync, atomic rename) happen on a
+// background thread under GAME_ROOT_PATH/saves.
+//
+// Saves after the first are deltas that hold only the sections whose bytes
+// changed since the previous save. Every SAVESTATE_MAX_DELTAS deltas the
+// chain restarts with a full snapshot. Loading maps the files and hands
+// each section's image to its fixup in place, without parsing.
+
+#define SAVESTATE_MAX_SECTIONS 64
+#define SAVESTATE_MAX_DELTAS 8
+#define SAVESTATE_NAME_SIZE 16 // Including the NUL
+#define SAVESTATE_ALIGNMENT 64 // Of every section image, in the file and in memory
+
+typedef struct Savestate Savestate;
+
+// Turns a loaded image into live state: translate stored offsets back into
+// pointers, migrate older versions, then copy into live. The image is a
+// private writable mapping, so fixups may patch it in place. Sections
+// without a fixup are copied as-is when their size and version match.
+typedef bool (*Savestate_Fixup)(void* live, size_t live_size, void* image, size_t image_size, uint32_t image_version, void* user);
+
+// name becomes the file stem, so it must be a plain file name.
+Savestate* Savestate_Create(const char* name);
+// Waits for a pending write.
+void Savestate_Destroy(Savestate* saver);
+
+// id must be unique and stable across builds; bump version whenever the
+// layout of the section changes. data must stay valid while registered.
+bool Savestate_AddSection(Savestate* saver, uint32_t id, const char* name, uint32_t version,
+  void* data, size_t size, Savestate_Fixup fixup, void* user);
+
+// Captures every section and queues the write. Returns false without
+// capturing while the previous save is still being written.
+bool Savestate_Save(Savestate* saver);
+bool Savestate_SaveFull(Savestate* saver); // Starts a new delta chain
+
+bool Savestate_IsBusy(const Savestate* saver);
+// Blocks until the pending write is durable. Returns false if it failed.
+bool Savestate_Wait(Savestate* saver);
+
+// Applies the newest full snapshot and its deltas to the registered
+// sections. Sections missing from the files keep their current contents.
+bool Savestate_Load(Savestate* saver);
+
+void Savestate_Benchmark(void);
+
+#endif
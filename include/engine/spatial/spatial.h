@@ -0,0 +1,40 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Uniform-grid spatial hash. Objects are axis-aligned boxes in world units;
+// moving an object only touches the grid when it crosses a cell boundary.
+
+typedef struct Spatial_Index Spatial_Index;
+
+// Batched query output. Results of query i are ids[offsets[i]] up to
+// ids[offsets[i + 1]]. Pair queries store each pair as two consecutive ids.
+typedef struct {
+  int* ids;
+  int count;
+  int capacity;
+  int* offsets;
+  int query_count;
+  int offsets_capacity;
+} Spatial_Results;
+
+Spatial_Index* Spatial_Create(float cell_size, int expected_objects);
+void Spatial_Destroy(Spatial_Index* index);
+
+int Spatial_Insert(Spatial_Index* index, SDL_FRect bounds, void* user_data); // Returns an id, or -1
+void Spatial_Remove(Spatial_Index* index, int id);
+void Spatial_Move(Spatial_Index* index, int id, SDL_FRect bounds);
+void* Spatial_GetUserData(const Spatial_Index* index, int id);
+int Spatial_GetCount(const Spatial_Index* index);
+
+void Spatial_QueryRegions(Spatial_Index* index, const SDL_FRect* regions, int count, Spatial_Results* results);
+void Spatial_QueryRadii(Spatial_Index* index, const SDL_FPoint* centers, const float* radii, int count, Spatial_Results* results);
+void Spatial_QueryPairs(Spatial_Index* index, Spatial_Results* results);
+
+void Spatial_FreeResults(Spatial_Results* results);
+
+void Spatial_Benchmark(void);
+
+#endif
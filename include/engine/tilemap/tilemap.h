@@ -0,0 +1,46 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Chunked tilemap. Visible chunks are pre-rendered into target textures that
+// are only rebuilt when one of their tiles changes, and evicted least recently
+// used first once the cache grows past its byte limit.
+
+typedef struct Tilemap Tilemap;
+
+#define TILEMAP_EMPTY_TILE 0
+
+typedef struct {
+  int chunks_drawn;
+  int chunks_rebuilt;
+  int chunks_evicted;
+  int chunks_cached;
+  size_t cache_bytes;
+} Tilemap_FrameStats;
+
+// Tile ids are 1-based cells of the tileset, read left to right, top to bottom.
+// Returns NULL if the renderer cannot render to textures.
+Tilemap* Tilemap_Create(SDL_Renderer* renderer, int width, int height, int tile_size, SDL_Texture* tileset, int tileset_columns);
+void Tilemap_Destroy(Tilemap* map);
+
+void Tilemap_SetCacheLimit(Tilemap* map, size_t bytes);
+void Tilemap_SetTile(Tilemap* map, int x, int y, uint16_t tile);
+uint16_t Tilemap_GetTile(const Tilemap* map, int x, int y);
+void Tilemap_InvalidateAll(Tilemap* map); // Call on SDL_RENDER_TARGETS_RESET
+
+// SDL_RENDER_DEVICE_RESET loses every texture: the cache is dropped and
+// rebuilt as chunks come back into view. The tileset stays the caller's, who
+// recreates it and hands it back through Tilemap_SetTileset.
+void Tilemap_OnDeviceReset(Tilemap* map);
+void Tilemap_SetTileset(Tilemap* map, SDL_Texture* tileset, int tileset_columns);
+
+// camera is in world pixels; its top-left lands on the output origin.
+void Tilemap_Draw(Tilemap* map, SDL_Renderer* renderer, const SDL_Rect* camera);
+Tilemap_FrameStats Tilemap_GetFrameStats(const Tilemap* map);
+
+void Tilemap_Benchmark(void);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Hierarchical timing wheel with 1 ms ticks, driven by whoever advances it
+// (the game loop), so callbacks run on that thread at a known point in the
+// frame. Scheduling and cancelling are O(1).
+
+typedef struct Timer_Wheel Timer_Wheel;
+
+// 0 is never a valid handle. Handles of fired or cancelled timers go stale
+// and cancelling them is a harmless no-op.
+typedef uint64_t Timer_Handle;
+
+typedef void (*Timer_Callback)(void* data);
+
+Timer_Wheel* Timer_CreateWheel(int capacity_hint);
+void Timer_DestroyWheel(Timer_Wheel* wheel);
+
+// period_ms of 0 makes a one-shot timer. A delay of 0 fires on the next tick.
+Timer_Handle Timer_Schedule(Timer_Wheel* wheel, uint64_t delay_ms, uint64_t period_ms, Timer_Callback callback, void* data);
+bool Timer_Cancel(Timer_Wheel* wheel, Timer_Handle handle);
+
+// Moves the wheel's clock forward, running every callback that comes due.
+void Timer_Advance(Timer_Wheel* wheel, uint64_t elapsed_ms);
+
+uint64_t Timer_GetTime(const Timer_Wheel* wheel);
+int Timer_GetPendingCount(const Timer_Wheel* wheel);
+// Milliseconds until the wheel next has work to do, capped at max_ms. Never
+// later than the first due timer, so it is safe to sleep that long.
+uint64_t Timer_NextDueIn(const Timer_Wheel* wheel, uint64_t max_ms);
+
+void Timer_Benchmark(void);
+
+#endif
@@ -1,11 +1,100 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <stdbool.h>
+
+#include <engine/spatial/spatial.h>
+#include <engine/timer/timer.h>
+#include <engine/coro/coro.h>
+#include <engine/audio/audio.h>
+#include <engine/input/input.h>
+#include <engine/overlay/overlay.h>
+#include <engine/tilemap/tilemap.h>
+
 typedef struct Game Game;
 
+typedef enum {
+    GAME_CLOCK_GAME,
+    GAME_CLOCK_REAL
+} Game_Clock;
+
+typedef enum {
+    GAME_RENDER_CONTINUOUS,
+    GAME_RENDER_ON_DEMAND
+} Game_RenderMode;
+
+// Loop activity over the last stats window. cpu_percent is process CPU time
+// divided by wall time, so it includes every thread the engine runs.
+typedef struct {
+    double cpu_percent;
+    double wakeups_per_second;
+    double frames_per_second;
+} Game_LoopStats;
+
 Game* Game_Init(Game** game);
 void Game_Destroy(Game* game);
 void Game_Run(Game* game);
 void Game_Test(void);
 
-#endif
\ No newline at end of file
+// On-demand rendering: the loop sleeps in SDL_WaitEventTimeout and skips the
+// present until a redraw is requested or an animation is active.
+void Game_SetRenderMode(Game* game, Game_RenderMode mode);
+void Game_RequestRedraw(Game* game);
+void Game_BeginAnimation(Game* game);
+void Game_EndAnimation(Game* game);
+Game_LoopStats Game_GetLoopStats(const Game* game);
+
+// Where the world is looked at from: x and y are the world point at the top
+// left of the window, zoom scales world units to pixels.
+typedef struct {
+    float x;
+    float y;
+    float zoom;
+} Game_Camera;
+
+// Called once per drawn frame, after the clear and before the overlay, with
+// the world ids whose bounds intersect view. Returns the draw calls it made.
+typedef int (*Game_DrawFunction)(SDL_Renderer* renderer, const SDL_FRect* view, const int* ids, int count, void* user);
+
+// World objects live in a spatial index. Each drawn frame culls it against
+// the camera's view and hands only the visible ids to the draw function;
+// without one the query is skipped.
+Spatial_Index* Game_GetWorld(Game* game);
+void Game_SetDrawFunction(Game* game, Game_DrawFunction draw, void* user);
+void Game_SetCamera(Game* game, Game_Camera camera);
+Game_Camera Game_GetCamera(const Game* game);
+// The world rectangle the camera shows in the current render output.
+SDL_FRect Game_GetView(const Game* game);
+// Ids of the last drawn frame.
+const int* Game_GetVisible(const Game* game, int* count_out);
+
+// Drawn under the world every frame from the camera, scaled by its zoom.
+// The game keeps the chunk cache valid when render targets or the device
+// are reset, but does not own the map; NULL detaches it.
+void Game_SetTilemap(Game* game, Tilemap* map);
+
+// Timers on GAME_CLOCK_GAME follow the scaled, pausable game clock; timers on
+// GAME_CLOCK_REAL follow wall time. Both fire once per loop iteration, after
+// events are handled and before the frame is drawn.
+Timer_Wheel* Game_GetTimers(Game* game, Game_Clock clock);
+void Game_SetTimeScale(Game* game, double scale);
+void Game_SetPaused(Game* game, bool paused);
+
+// Coroutines spawned here run once per loop iteration, right after timers,
+// so multi-frame logic can wait on Game_GetTimers wheels, jobs or events.
+// In on-demand mode a coroutine waiting in Coro_NextFrame keeps frames
+// coming, like an active animation.
+Coro_Scheduler* Game_GetCoroutines(Game* game);
+
+// NULL when no audio device could be opened; Audio_* calls accept that.
+Audio_Mixer* Game_GetAudio(Game* game);
+
+// This frame's input, folded from every event drained at the top of the
+// loop. Valid until the next iteration.
+const Input_Snapshot* Game_GetInput(const Game* game);
+
+// Debug HUD over every drawn frame, toggled with F3. NULL if it could not
+// be created; Overlay_* calls accept that.
+Overlay* Game_GetOverlay(Game* game);
+
+#endif
@@ -0,0 +1,1373 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <engine/audio/audio.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <SDL2/SDL.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIO_HAS_X86 1
+#else
+#define AUDIO_HAS_X86 0
+#endif
+
+#define AUDIO_DEFAULT_FREQUENCY 48000
+#define AUDIO_DEFAULT_BUFFER_FRAMES 512
+#define AUDIO_DEFAULT_MAX_VOICES 64
+#define AUDIO_MAX_VOICES 1024
+#define AUDIO_QUEUE_SIZE 1024 // Power of two, and at least AUDIO_MAX_VOICES
+#define AUDIO_CHUNK_FRAMES 1024
+#define AUDIO_ALIGNMENT 32
+#define AUDIO_MAX_PITCH 8.0f
+#define AUDIO_GUARD_FRAMES 4 // Past the end of every source, for interpolation and float rounding
+#define AUDIO_QUARTER_PI 0.78539816f
+#define AUDIO_FRACTION_BITS 32
+#define AUDIO_FRACTION_MASK ((UINT64_C(1) << AUDIO_FRACTION_BITS) - 1)
+
+#define AUDIO_STREAM_RING_FRAMES 32768 // Power of two
+#define AUDIO_STREAM_MIRROR_FRAMES 2048
+#define AUDIO_STREAM_DECODE_FRAMES 4096
+#define AUDIO_DECODER_INTERVAL_MS 10
+
+#define AUDIO_WAV_PCM 1
+#define AUDIO_WAV_FLOAT 3
+#define AUDIO_WAV_EXTENSIBLE 0xFFFE
+
+typedef enum {
+  AUDIO_KERNEL_SCALAR,
+  AUDIO_KERNEL_SSE2,
+  AUDIO_KERNEL_AVX2
+} Audio_Kernel;
+
+// One voice's slice of source audio for a single kernel call. Source frame
+// i of the output reads at frac + i * step past src, which the caller
+// guarantees stays inside the source including the interpolation partner.
+typedef struct {
+  const float* src_l;
+  const float* src_r;
+  float frac;
+  float step;
+  float gain_l, gain_r;
+  float gain_step_l, gain_step_r; // Per output frame, for ramps
+} Audio_MixParams;
+
+typedef struct {
+  void (*mix)(float* out_l, float* out_r, int frames, const Audio_MixParams* p);
+  void (*output)(float* out, const float* left, const float* right, int frames); // Clamp and interleave
+} Audio_Kernels;
+
+struct Audio_Sound {
+  float* left;
+  float* right; // Aliases left for mono sounds
+  int frames;   // Each plane holds AUDIO_GUARD_FRAMES more past this
+  int frequency;
+
+  // The last frame followed by silence, read instead of the looping guard
+  // frames once a non-looping voice reaches it.
+  float tail_left[AUDIO_GUARD_FRAMES + 1];
+  float tail_right[AUDIO_GUARD_FRAMES + 1];
+};
+
+typedef struct {
+  FILE* file;
+  int channels;
+  int frequency;
+  int format;
+  int bits;
+  int block_align;
+  long data_start;
+  uint32_t data_bytes;
+  uint32_t data_read;
+  unsigned char* buffer; // AUDIO_STREAM_DECODE_FRAMES blocks
+} Audio_WavReader;
+
+// Single producer, single consumer ring. The decoder thread writes, the
+// callback reads. The first AUDIO_STREAM_MIRROR_FRAMES are mirrored past
+// the end so reads straddling the wrap stay contiguous.
+typedef struct Audio_Stream Audio_Stream;
+struct Audio_Stream {
+  Audio_WavReader reader;
+  bool loop;
+  float* left;
+  float* right;
+
+  _Alignas(64) atomic_uint_fast64_t write_pos;
+  _Alignas(64) atomic_uint_fast64_t read_pos;
+  atomic_bool eof;     // Decoder reached the end; nothing more is coming
+  atomic_bool closing; // Voice finished; the decoder frees the stream
+
+  Audio_Stream* next; // Decoder list
+};
+
+typedef enum {
+  AUDIO_COMMAND_PLAY,
+  AUDIO_COMMAND_VOLUME,
+  AUDIO_COMMAND_PAN,
+  AUDIO_COMMAND_STOP
+} Audio_CommandType;
+
+typedef struct {
+  Audio_CommandType type;
+  int slot;
+  uint32_t generation;
+  const Audio_Sound* sound;
+  Audio_Stream* stream;
+  uint64_t step;
+  bool loop;
+  float volume;
+  float pan;
+  int ramp_frames;
+} Audio_Command;
+
+typedef struct {
+  Audio_Command items[AUDIO_QUEUE_SIZE];
+  _Alignas(64) atomic_uint head; // Consumer
+  _Alignas(64) atomic_uint tail; // Producer
+} Audio_CommandQueue;
+
+typedef struct {
+  int items[AUDIO_QUEUE_SIZE];
+  _Alignas(64) atomic_uint head;
+  _Alignas(64) atomic_uint tail;
+} Audio_SlotQueue;
+
+// Owned by the callback.
+typedef struct {
+  bool active;
+  bool stopping; // Finish once the fade reaches zero
+  uint32_t generation;
+  const Audio_Sound* sound;
+  Audio_Stream* stream;
+  bool loop;
+
+  uint64_t position; // 32.32 fixed point source frames; for streams, past read_pos
+  uint64_t step;
+
+  float volume, pan;
+  float gain_l, gain_r;
+  float target_l, target_r;
+  float step_l, step_r;
+  int ramp_left;
+} Audio_VoiceState;
+
+// Owned by the game thread.
+typedef struct {
+  bool busy;
+  uint32_t generation;
+  Audio_Stream* stream;
+} Audio_Slot;
+
+struct Audio_Mixer {
+  SDL_AudioDeviceID device;
+  int frequency;
+  int buffer_frames;
+  int max_voices;
+
+  Audio_CommandQueue commands;
+  Audio_SlotQueue finished;
+
+  Audio_Slot* slots;
+  int active_voices;
+
+  Audio_VoiceState* voices;
+  float* mix_l;
+  float* mix_r;
+
+  pthread_t decoder;
+  bool decoder_started;
+  bool decoder_running;
+  pthread_mutex_t decoder_mutex;
+  pthread_cond_t decoder_cond;
+  Audio_Stream* incoming; // Handed to the decoder under decoder_mutex
+  Audio_Stream* streams;  // Decoder thread only
+
+  atomic_uint_fast64_t callback_count;
+  atomic_uint_fast64_t callback_ns;
+
+  Metrics_Histogram* callback_metric;
+  Metrics_Counter* underrun_metric;
+  Metrics_Gauge* voices_metric;
+};
+
+static Audio_Kernel g_kernel = AUDIO_KERNEL_SCALAR;
+static bool g_kernel_detected = false;
+
+
+/* ---- Scalar kernels ---- */
+
+static inline void audio_mix_range(float* out_l, float* out_r, int begin, int end, const Audio_MixParams* p) {
+  for (int i = begin; i < end; i++) {
+    float rel = p->frac + (float)i * p->step;
+    int idx = (int)rel;
+    float t = rel - (float)idx;
+
+    float l = p->src_l[idx] + (p->src_l[idx + 1] - p->src_l[idx]) * t;
+    float r = p->src_r[idx] + (p->src_r[idx + 1] - p->src_r[idx]) * t;
+    out_l[i] += l * (p->gain_l + (float)i * p->gain_step_l);
+    out_r[i] += r * (p->gain_r + (float)i * p->gain_step_r);
+  }
+}
+
+static void audio_mix_scalar(float* out_l, float* out_r, int frames, const Audio_MixParams* p) {
+  audio_mix_range(out_l, out_r, 0, frames, p);
+}
+
+static inline float audio_clamp(float sample) {
+  return sample < -1.0f ? -1.0f : (sample > 1.0f ? 1.0f : sample);
+}
+
+static inline void audio_output_range(float* out, const float* left, const float* right, int begin, int end) {
+  for (int i = begin; i < end; i++) {
+    out[2 * i] = audio_clamp(left[i]);
+    out[2 * i + 1] = audio_clamp(right[i]);
+  }
+}
+
+static void audio_output_scalar(float* out, const float* left, const float* right, int frames) {
+  audio_output_range(out, left, right, 0, frames);
+}
+
+
+/* ---- SSE2 / AVX2 kernels ----
+ * Unit-rate voices read straight from the source. Resampled ones compute
+ * per-lane positions relative to the call's start, which keeps them small
+ * enough for float, and gather both interpolation taps. Tails fall back to
+ * the scalar range so AVX2 code never mixes in SSE instructions. */
+
+#if AUDIO_HAS_X86
+
+__attribute__((target("sse2")))
+static void audio_mix_sse2(float* out_l, float* out_r, int frames, const Audio_MixParams* p) {
+  __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  __m128 gl = _mm_add_ps(_mm_set1_ps(p->gain_l), _mm_mul_ps(lane, _mm_set1_ps(p->gain_step_l)));
+  __m128 gr = _mm_add_ps(_mm_set1_ps(p->gain_r), _mm_mul_ps(lane, _mm_set1_ps(p->gain_step_r)));
+  __m128 gl_step = _mm_set1_ps(4.0f * p->gain_step_l);
+  __m128 gr_step = _mm_set1_ps(4.0f * p->gain_step_r);
+  int i = 0;
+
+  if (p->step == 1.0f && p->frac == 0.0f) {
+    for (; i + 4 <= frames; i += 4) {
+      __m128 l = _mm_loadu_ps(p->src_l + i);
+      __m128 r = _mm_loadu_ps(p->src_r + i);
+      _mm_storeu_ps(out_l + i, _mm_add_ps(_mm_loadu_ps(out_l + i), _mm_mul_ps(l, gl)));
+      _mm_storeu_ps(out_r + i, _mm_add_ps(_mm_loadu_ps(out_r + i), _mm_mul_ps(r, gr)));
+      gl = _mm_add_ps(gl, gl_step);
+      gr = _mm_add_ps(gr, gr_step);
+    }
+  } else {
+    __m128 frac = _mm_set1_ps(p->frac);
+    __m128 step = _mm_set1_ps(p->step);
+    int32_t k[4];
+
+    for (; i + 4 <= frames; i += 4) {
+      __m128 rel = _mm_add_ps(frac, _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)i), lane), step));
+      __m128i idx = _mm_cvttps_epi32(rel);
+      __m128 t = _mm_sub_ps(rel, _mm_cvtepi32_ps(idx));
+      _mm_storeu_si128((__m128i*)k, idx);
+
+      __m128 l0 = _mm_setr_ps(p->src_l[k[0]], p->src_l[k[1]], p->src_l[k[2]], p->src_l[k[3]]);
+      __m128 l1 = _mm_setr_ps(p->src_l[k[0] + 1], p->src_l[k[1] + 1], p->src_l[k[2] + 1], p->src_l[k[3] + 1]);
+      __m128 r0 = _mm_setr_ps(p->src_r[k[0]], p->src_r[k[1]], p->src_r[k[2]], p->src_r[k[3]]);
+      __m128 r1 = _mm_setr_ps(p->src_r[k[0] + 1], p->src_r[k[1] + 1], p->src_r[k[2] + 1], p->src_r[k[3] + 1]);
+      __m128 l = _mm_add_ps(l0, _mm_mul_ps(_mm_sub_ps(l1, l0), t));
+      __m128 r = _mm_add_ps(r0, _mm_mul_ps(_mm_sub_ps(r1, r0), t));
+
+      _mm_storeu_ps(out_l + i, _mm_add_ps(_mm_loadu_ps(out_l + i), _mm_mul_ps(l, gl)));
+      _mm_storeu_ps(out_r + i, _mm_add_ps(_mm_loadu_ps(out_r + i), _mm_mul_ps(r, gr)));
+      gl = _mm_add_ps(gl, gl_step);
+      gr = _mm_add_ps(gr, gr_step);
+    }
+  }
+
+  audio_mix_range(out_l, out_r, i, frames, p);
+}
+
+__attribute__((target("sse2")))
+static void audio_output_sse2(float* out, const float* left, const float* right, int frames) {
+  __m128 lo = _mm_set1_ps(-1.0f);
+  __m128 hi = _mm_set1_ps(1.0f);
+  int i = 0;
+
+  for (; i + 4 <= frames; i += 4) {
+    __m128 l = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(left + i), lo), hi);
+    __m128 r = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(right + i), lo), hi);
+    _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+  }
+
+  audio_output_range(out, left, right, i, frames);
+}
+
+__attribute__((target("avx2")))
+static void audio_mix_avx2(float* out_l, float* out_r, int frames, const Audio_MixParams* p) {
+  __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+  __m256 gl = _mm256_add_ps(_mm256_set1_ps(p->gain_l), _mm256_mul_ps(lane, _mm256_set1_ps(p->gain_step_l)));
+  __m256 gr = _mm256_add_ps(_mm256_set1_ps(p->gain_r), _mm256_mul_ps(lane, _mm256_set1_ps(p->gain_step_r)));
+  __m256 gl_step = _mm256_set1_ps(8.0f * p->gain_step_l);
+  __m256 gr_step = _mm256_set1_ps(8.0f * p->gain_step_r);
+  int i = 0;
+
+  if (p->step == 1.0f && p->frac == 0.0f) {
+    for (; i + 8 <= frames; i += 8) {
+      __m256 l = _mm256_loadu_ps(p->src_l + i);
+      __m256 r = _mm256_loadu_ps(p->src_r + i);
+      _mm256_storeu_ps(out_l + i, _mm256_add_ps(_mm256_loadu_ps(out_l + i), _mm256_mul_ps(l, gl)));
+      _mm256_storeu_ps(out_r + i, _mm256_add_ps(_mm256_loadu_ps(out_r + i), _mm256_mul_ps(r, gr)));
+      gl = _mm256_add_ps(gl, gl_step);
+      gr = _mm256_add_ps(gr, gr_step);
+    }
+  } else {
+    __m256 frac = _mm256_set1_ps(p->frac);
+    __m256 step = _mm256_set1_ps(p->step);
+    __m256i one = _mm256_set1_epi32(1);
+
+    for (; i + 8 <= frames; i += 8) {
+      __m256 rel = _mm256_add_ps(frac, _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)i), lane), step));
+      __m256i idx = _mm256_cvttps_epi32(rel);
+      __m256i next = _mm256_add_epi32(idx, one);
+      __m256 t = _mm256_sub_ps(rel, _mm256_cvtepi32_ps(idx));
+
+      __m256 l0 = _mm256_i32gather_ps(p->src_l, idx, 4);
+      __m256 l1 = _mm256_i32gather_ps(p->src_l, next, 4);
+      __m256 r0 = _mm256_i32gather_ps(p->src_r, idx, 4);
+      __m256 r1 = _mm256_i32gather_ps(p->src_r, next, 4);
+      __m256 l = _mm256_add_ps(l0, _mm256_mul_ps(_mm256_sub_ps(l1, l0), t));
+      __m256 r = _mm256_add_ps(r0, _mm256_mul_ps(_mm256_sub_ps(r1, r0), t));
+
+      _mm256_storeu_ps(out_l + i, _mm256_add_ps(_mm256_loadu_ps(out_l + i), _mm256_mul_ps(l, gl)));
+      _mm256_storeu_ps(out_r + i, _mm256_add_ps(_mm256_loadu_ps(out_r + i), _mm256_mul_ps(r, gr)));
+      gl = _mm256_add_ps(gl, gl_step);
+      gr = _mm256_add_ps(gr, gr_step);
+    }
+  }
+
+  audio_mix_range(out_l, out_r, i, frames, p);
+}
+
+__attribute__((target("avx2")))
+static void audio_output_avx2(float* out, const float* left, const float* right, int frames) {
+  __m256 lo = _mm256_set1_ps(-1.0f);
+  __m256 hi = _mm256_set1_ps(1.0f);
+  int i = 0;
+
+  for (; i + 8 <= frames; i += 8) {
+    __m256 l = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(left + i), lo), hi);
+    __m256 r = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(right + i), lo), hi);
+    // unpack works within 128-bit halves, so the permutes restore frame order.
+    __m256 a = _mm256_unpacklo_ps(l, r);
+    __m256 b = _mm256_unpackhi_ps(l, r);
+    _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(a, b, 0x20));
+    _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(a, b, 0x31));
+  }
+
+  audio_output_range(out, left, right, i, frames);
+}
+
+#endif
+
+
+/* ---- Kernel selection ---- */
+
+static Audio_Kernel internal_audio_kernel(void) {
+  if (!g_kernel_detected) {
+#if AUDIO_HAS_X86
+    if (SDL_HasAVX2()) {
+      g_kernel = AUDIO_KERNEL_AVX2;
+    } else if (SDL_HasSSE2()) {
+      g_kernel = AUDIO_KERNEL_SSE2;
+    }
+#endif
+    g_kernel_detected = true;
+  }
+
+  return g_kernel;
+}
+
+static Audio_Kernels internal_audio_kernels(void) {
+  switch (internal_audio_kernel()) {
+#if AUDIO_HAS_X86
+    case AUDIO_KERNEL_AVX2:
+      return (Audio_Kernels){ audio_mix_avx2, audio_output_avx2 };
+    case AUDIO_KERNEL_SSE2:
+      return (Audio_Kernels){ audio_mix_sse2, audio_output_sse2 };
+#endif
+    default:
+      return (Audio_Kernels){ audio_mix_scalar, audio_output_scalar };
+  }
+}
+
+
+/* ---- WAV decoding ---- */
+
+static inline uint16_t internal_audio_u16(const unsigned char* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t internal_audio_u32(const unsigned char* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void internal_audio_wav_close(Audio_WavReader* reader) {
+  if (reader->file) fclose(reader->file);
+  free(reader->buffer);
+  reader->file = NULL;
+  reader->buffer = NULL;
+}
+
+static bool internal_audio_wav_open(Audio_WavReader* reader, const char* path) {
+  memset(reader, 0, sizeof(Audio_WavReader));
+
+  reader->file = fopen(path, "rb");
+  if (!reader->file) {
+    LOGGER_ERROR("Failed to open sound %s\n", path);
+    return false;
+  }
+
+  unsigned char header[12];
+  if (fread(header, 1, sizeof(header), reader->file) != sizeof(header)
+    || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+    LOGGER_ERROR("%s is not a WAV file\n", path);
+    internal_audio_wav_close(reader);
+    return false;
+  }
+
+  bool have_format = false;
+  unsigned char chunk[8];
+  while (fread(chunk, 1, sizeof(chunk), reader->file) == sizeof(chunk)) {
+    uint32_t size = internal_audio_u32(chunk + 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+      unsigned char format[40] = {0};
+      uint32_t wanted = size < sizeof(format) ? size : (uint32_t)sizeof(format);
+      if (fread(format, 1, wanted, reader->file) != wanted) break;
+      if (size > wanted) fseek(reader->file, (long)(size - wanted), SEEK_CUR);
+
+      reader->format = internal_audio_u16(format);
+      reader->channels = internal_audio_u16(format + 2);
+      reader->frequency = (int)internal_audio_u32(format + 4);
+      reader->block_align = internal_audio_u16(format + 12);
+      reader->bits = internal_audio_u16(format + 14);
+      if (reader->format == AUDIO_WAV_EXTENSIBLE && size >= 26) reader->format = internal_audio_u16(format + 24);
+      have_format = true;
+    } else if (memcmp(chunk, "data", 4) == 0 && have_format) {
+      reader->data_start = ftell(reader->file);
+      reader->data_bytes = size;
+      break;
+    } else {
+      fseek(reader->file, (long)(size + (size & 1)), SEEK_CUR);
+    }
+  }
+
+  bool supported = reader->format == AUDIO_WAV_PCM
+    ? (reader->bits == 8 || reader->bits == 16 || reader->bits == 24 || reader->bits == 32)
+    : (reader->format == AUDIO_WAV_FLOAT && reader->bits == 32);
+
+  if (reader->data_start == 0 || !supported || reader->channels < 1 || reader->frequency <= 0
+    || reader->block_align < reader->channels * reader->bits / 8) {
+    LOGGER_ERROR("Unsupported WAV encoding in %s\n", path);
+    internal_audio_wav_close(reader);
+    return false;
+  }
+
+  reader->buffer = malloc((size_t)AUDIO_STREAM_DECODE_FRAMES * reader->block_align);
+  if (!reader->buffer) {
+    internal_audio_wav_close(reader);
+    return false;
+  }
+
+  return true;
+}
+
+static bool internal_audio_wav_rewind(Audio_WavReader* reader) {
+  reader->data_read = 0;
+  return fseek(reader->file, reader->data_start, SEEK_SET) == 0;
+}
+
+static inline float internal_audio_wav_sample(const Audio_WavReader* reader, const unsigned char* p) {
+  switch (reader->bits) {
+    case 8:
+      return ((float)p[0] - 128.0f) * (1.0f / 128.0f);
+    case 16:
+      return (float)(int16_t)internal_audio_u16(p) * (1.0f / 32768.0f);
+    case 24:
+      return (float)((int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8) * (1.0f / 8388608.0f);
+    default: {
+      uint32_t bits = internal_audio_u32(p);
+      if (reader->format == AUDIO_WAV_FLOAT) {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+      return (float)(int32_t)bits * (1.0f / 2147483648.0f);
+    }
+  }
+}
+
+// Decodes up to frames frames into the planes; extra channels are dropped
+// and mono fills both planes. Returns 0 at the end of the data.
+static int internal_audio_wav_read(Audio_WavReader* reader, float* left, float* right, int frames) {
+  uint32_t remaining = (reader->data_bytes - reader->data_read) / (uint32_t)reader->block_align;
+  if ((uint32_t)frames > remaining) frames = (int)remaining;
+  if (frames > AUDIO_STREAM_DECODE_FRAMES) frames = AUDIO_STREAM_DECODE_FRAMES;
+  if (frames <= 0) return 0;
+
+  size_t got = fread(reader->buffer, (size_t)reader->block_align, (size_t)frames, reader->file);
+  reader->data_read += (uint32_t)(got * (size_t)reader->block_align);
+
+  int second = reader->channels > 1 ? reader->bits / 8 : 0;
+  for (size_t i = 0; i < got; i++) {
+    const unsigned char* frame = reader->buffer + i * (size_t)reader->block_align;
+    left[i] = internal_audio_wav_sample(reader, frame);
+    right[i] = internal_audio_wav_sample(reader, frame + second);
+  }
+
+  return (int)got;
+}
+
+
+/* ---- Sounds ---- */
+
+static Audio_Sound* internal_audio_sound_alloc(int frames, int channels, int frequency) {
+  Audio_Sound* sound = calloc(1, sizeof(Audio_Sound));
+  if (!sound) return NULL;
+
+  sound->frames = frames;
+  sound->frequency = frequency;
+  sound->left = malloc(((size_t)frames + AUDIO_GUARD_FRAMES) * sizeof(float));
+  sound->right = channels > 1 ? malloc(((size_t)frames + AUDIO_GUARD_FRAMES) * sizeof(float)) : sound->left;
+  if (!sound->left || !sound->right) {
+    Audio_DestroySound(sound);
+    return NULL;
+  }
+
+  return sound;
+}
+
+// Guard frames continue from the start, so a looping voice interpolates
+// across the seam. A non-looping voice fades its last frame into silence
+// through the tail instead of into the first frame.
+static void internal_audio_sound_finish(Audio_Sound* sound) {
+  for (int i = 0; i < AUDIO_GUARD_FRAMES; i++) {
+    sound->left[sound->frames + i] = sound->left[i % sound->frames];
+    sound->right[sound->frames + i] = sound->right[i % sound->frames];
+  }
+
+  memset(sound->tail_left, 0, sizeof(sound->tail_left));
+  memset(sound->tail_right, 0, sizeof(sound->tail_right));
+  sound->tail_left[0] = sound->left[sound->frames - 1];
+  sound->tail_right[0] = sound->right[sound->frames - 1];
+}
+
+Audio_Sound* Audio_CreateSound(const float* samples, int frames, int channels, int frequency) {
+  if (!samples || frames <= 0 || channels <= 0 || frequency <= 0) return NULL;
+
+  Audio_Sound* sound = internal_audio_sound_alloc(frames, channels, frequency);
+  if (!sound) return NULL;
+
+  for (int i = 0; i < frames; i++) {
+    sound->left[i] = samples[(size_t)i * channels];
+    if (channels > 1) sound->right[i] = samples[(size_t)i * channels + 1];
+  }
+  internal_audio_sound_finish(sound);
+
+  return sound;
+}
+
+Audio_Sound* Audio_LoadSound(const char* wav_path) {
+  Audio_WavReader reader;
+  if (!internal_audio_wav_open(&reader, wav_path)) return NULL;
+
+  int frames = (int)(reader.data_bytes / (uint32_t)reader.block_align);
+  Audio_Sound* sound = frames > 0 ? internal_audio_sound_alloc(frames, reader.channels, reader.frequency) : NULL;
+  if (!sound) {
+    LOGGER_ERROR("Failed to load sound %s\n", wav_path);
+    internal_audio_wav_close(&reader);
+    return NULL;
+  }
+
+  int loaded = 0;
+  while (loaded < frames) {
+    int got = internal_audio_wav_read(&reader, sound->left + loaded, sound->right + loaded, frames - loaded);
+    if (got == 0) break;
+    loaded += got;
+  }
+  internal_audio_wav_close(&reader);
+
+  // A truncated file plays what it has.
+  if (loaded == 0) {
+    LOGGER_ERROR("Sound %s has no audio data\n", wav_path);
+    Audio_DestroySound(sound);
+    return NULL;
+  }
+  sound->frames = loaded;
+  internal_audio_sound_finish(sound);
+
+  return sound;
+}
+
+void Audio_DestroySound(Audio_Sound* sound) {
+  if (!sound) return;
+
+  if (sound->right != sound->left) free(sound->right);
+  free(sound->left);
+  free(sound);
+}
+
+
+/* ---- Streams ---- */
+
+static void internal_audio_stream_free(Audio_Stream* stream) {
+  internal_audio_wav_close(&stream->reader);
+  free(stream->left);
+  free(stream->right);
+  free(stream);
+}
+
+static Audio_Stream* internal_audio_stream_open(const char* path, bool loop) {
+  Audio_Stream* stream = calloc(1, sizeof(Audio_Stream));
+  if (!stream) return NULL;
+
+  if (!internal_audio_wav_open(&stream->reader, path)) {
+    free(stream);
+    return NULL;
+  }
+
+  size_t bytes = (AUDIO_STREAM_RING_FRAMES + AUDIO_STREAM_MIRROR_FRAMES + AUDIO_GUARD_FRAMES) * sizeof(float);
+  stream->left = calloc(1, bytes);
+  stream->right = calloc(1, bytes);
+  if (!stream->left || !stream->right) {
+    internal_audio_stream_free(stream);
+    return NULL;
+  }
+
+  stream->loop = loop;
+  atomic_init(&stream->write_pos, 0);
+  atomic_init(&stream->read_pos, 0);
+  atomic_init(&stream->eof, false);
+  atomic_init(&stream->closing, false);
+
+  return stream;
+}
+
+static void internal_audio_stream_mirror(Audio_Stream* stream, int index, int count) {
+  if (index >= AUDIO_STREAM_MIRROR_FRAMES) return;
+
+  int mirrored = index + count < AUDIO_STREAM_MIRROR_FRAMES ? count : AUDIO_STREAM_MIRROR_FRAMES - index;
+  memcpy(stream->left + AUDIO_STREAM_RING_FRAMES + index, stream->left + index, (size_t)mirrored * sizeof(float));
+  memcpy(stream->right + AUDIO_STREAM_RING_FRAMES + index, stream->right + index, (size_t)mirrored * sizeof(float));
+}
+
+// Tops the ring up. Runs on the decoder thread only.
+static void internal_audio_stream_fill(Audio_Stream* stream) {
+  if (atomic_load_explicit(&stream->eof, memory_order_relaxed)) return;
+
+  uint64_t write = atomic_load_explicit(&stream->write_pos, memory_order_relaxed);
+  bool rewound = false;
+
+  for (;;) {
+    uint64_t read = atomic_load_explicit(&stream->read_pos, memory_order_acquire);
+    int space = AUDIO_STREAM_RING_FRAMES - (int)(write - read);
+    int index = (int)(write & (AUDIO_STREAM_RING_FRAMES - 1));
+    int contiguous = AUDIO_STREAM_RING_FRAMES - index;
+    int count = space < contiguous ? space : contiguous;
+    if (count <= 0) return;
+
+    int got = internal_audio_wav_read(&stream->reader, stream->left + index, stream->right + index, count);
+    if (got == 0) {
+      // An empty loop would spin forever, so one rewind per fill is enough.
+      if (stream->loop && !rewound && internal_audio_wav_rewind(&stream->reader)) {
+        rewound = true;
+        continue;
+      }
+
+      // Trailing silence gives the last sample an interpolation partner.
+      stream->left[index] = 0.0f;
+      stream->right[index] = 0.0f;
+      internal_audio_stream_mirror(stream, index, 1);
+      atomic_store_explicit(&stream->write_pos, write + 1, memory_order_release);
+      atomic_store_explicit(&stream->eof, true, memory_order_release);
+      return;
+    }
+
+    rewound = false;
+    internal_audio_stream_mirror(stream, index, got);
+    write += (uint64_t)got;
+    atomic_store_explicit(&stream->write_pos, write, memory_order_release);
+  }
+}
+
+static void* internal_audio_decoder_main(void* arg) {
+  Audio_Mixer* mixer = arg;
+
+  pthread_mutex_lock(&mixer->decoder_mutex);
+  while (mixer->decoder_running) {
+    while (mixer->incoming) {
+      Audio_Stream* stream = mixer->incoming;
+      mixer->incoming = stream->next;
+      stream->next = mixer->streams;
+      mixer->streams = stream;
+    }
+    pthread_mutex_unlock(&mixer->decoder_mutex);
+
+    Audio_Stream** link = &mixer->streams;
+    while (*link) {
+      Audio_Stream* stream = *link;
+      if (atomic_load_explicit(&stream->closing, memory_order_acquire)) {
+        *link = stream->next;
+        internal_audio_stream_free(stream);
+        continue;
+      }
+      internal_audio_stream_fill(stream);
+      link = &stream->next;
+    }
+
+    pthread_mutex_lock(&mixer->decoder_mutex);
+    if (!mixer->decoder_running || mixer->incoming) continue;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += AUDIO_DECODER_INTERVAL_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&mixer->decoder_cond, &mixer->decoder_mutex, &deadline);
+  }
+  pthread_mutex_unlock(&mixer->decoder_mutex);
+
+  return NULL;
+}
+
+
+/* ---- Queues ---- */
+
+static bool internal_audio_command_push(Audio_CommandQueue* queue, const Audio_Command* command) {
+  unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  if (tail - head == AUDIO_QUEUE_SIZE) return false;
+
+  queue->items[tail & (AUDIO_QUEUE_SIZE - 1)] = *command;
+  atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+static bool internal_audio_command_pop(Audio_CommandQueue* queue, Audio_Command* command) {
+  unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  unsigned tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+  if (head == tail) return false;
+
+  *command = queue->items[head & (AUDIO_QUEUE_SIZE - 1)];
+  atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+  return true;
+}
+
+// Never fills: a slot is only queued once per use and there are at most
+// AUDIO_MAX_VOICES of them.
+static void internal_audio_slot_push(Audio_SlotQueue* queue, int slot) {
+  unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  queue->items[tail & (AUDIO_QUEUE_SIZE - 1)] = slot;
+  atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+}
+
+static bool internal_audio_slot_pop(Audio_SlotQueue* queue, int* slot) {
+  unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  unsigned tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+  if (head == tail) return false;
+
+  *slot = queue->items[head & (AUDIO_QUEUE_SIZE - 1)];
+  atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+  return true;
+}
+
+
+/* ---- Mixing (audio callback thread) ---- */
+
+// Constant-power pan, so a centred voice is as loud as a hard-panned one.
+static void internal_audio_pan_gains(float volume, float pan, float* gain_l, float* gain_r) {
+  if (pan < -1.0f) pan = -1.0f;
+  if (pan > 1.0f) pan = 1.0f;
+
+  float angle = (pan + 1.0f) * AUDIO_QUARTER_PI;
+  *gain_l = volume * cosf(angle);
+  *gain_r = volume * sinf(angle);
+}
+
+static void internal_audio_ramp(Audio_VoiceState* voice, int ramp_frames) {
+  internal_audio_pan_gains(voice->volume, voice->pan, &voice->target_l, &voice->target_r);
+
+  if (ramp_frames <= 0) {
+    voice->gain_l = voice->target_l;
+    voice->gain_r = voice->target_r;
+    voice->ramp_left = 0;
+    return;
+  }
+
+  voice->step_l = (voice->target_l - voice->gain_l) / (float)ramp_frames;
+  voice->step_r = (voice->target_r - voice->gain_r) / (float)ramp_frames;
+  voice->ramp_left = ramp_frames;
+}
+
+static void internal_audio_finish(Audio_Mixer* mixer, int slot) {
+  mixer->voices[slot].active = false;
+  internal_audio_slot_push(&mixer->finished, slot);
+}
+
+static void internal_audio_apply(Audio_Mixer* mixer, const Audio_Command* command) {
+  Audio_VoiceState* voice = &mixer->voices[command->slot];
+
+  if (command->type == AUDIO_COMMAND_PLAY) {
+    *voice = (Audio_VoiceState){0};
+    voice->active = true;
+    voice->generation = command->generation;
+    voice->sound = command->sound;
+    voice->stream = command->stream;
+    voice->loop = command->loop;
+    voice->step = command->step;
+    voice->volume = command->volume;
+    voice->pan = command->pan;
+    internal_audio_ramp(voice, 0);
+    return;
+  }
+
+  if (!voice->active || voice->generation != command->generation) return;
+
+  switch (command->type) {
+    case AUDIO_COMMAND_VOLUME:
+      voice->volume = command->volume;
+      internal_audio_ramp(voice, command->ramp_frames);
+      break;
+    case AUDIO_COMMAND_PAN:
+      voice->pan = command->pan;
+      internal_audio_ramp(voice, command->ramp_frames);
+      break;
+    case AUDIO_COMMAND_STOP:
+      if (command->ramp_frames <= 0) {
+        internal_audio_finish(mixer, command->slot);
+        break;
+      }
+      voice->volume = 0.0f;
+      voice->stopping = true;
+      internal_audio_ramp(voice, command->ramp_frames);
+      break;
+    default:
+      break;
+  }
+}
+
+// Finds the source window for the voice's current position. Returns false
+// when the voice has nothing to play right now.
+static bool internal_audio_source(Audio_Mixer* mixer, Audio_VoiceState* voice, int slot,
+  const float** left, const float** right, uint64_t* available) {
+  if (voice->sound) {
+    const Audio_Sound* sound = voice->sound;
+    uint64_t base = voice->position >> AUDIO_FRACTION_BITS;
+
+    if (base >= (uint64_t)sound->frames) {
+      if (!voice->loop) {
+        internal_audio_finish(mixer, slot);
+        return false;
+      }
+      base %= (uint64_t)sound->frames;
+      voice->position = (base << AUDIO_FRACTION_BITS) | (voice->position & AUDIO_FRACTION_MASK);
+    }
+
+    if (voice->loop) {
+      *left = sound->left + base;
+      *right = sound->right + base;
+      *available = (uint64_t)sound->frames + 1 - base;
+    } else if (base + 1 < (uint64_t)sound->frames) {
+      *left = sound->left + base;
+      *right = sound->right + base;
+      *available = (uint64_t)sound->frames - base;
+    } else {
+      *left = sound->tail_left;
+      *right = sound->tail_right;
+      *available = 2;
+    }
+    return true;
+  }
+
+  Audio_Stream* stream = voice->stream;
+  uint64_t read = atomic_load_explicit(&stream->read_pos, memory_order_relaxed);
+  uint64_t write = atomic_load_explicit(&stream->write_pos, memory_order_acquire);
+  uint64_t buffered = write - read;
+
+  // Consume whole frames the position moved past, as far as decoded.
+  uint64_t base = voice->position >> AUDIO_FRACTION_BITS;
+  uint64_t consumed = base < buffered ? base : buffered;
+  if (consumed > 0) {
+    read += consumed;
+    buffered -= consumed;
+    voice->position -= consumed << AUDIO_FRACTION_BITS;
+    atomic_store_explicit(&stream->read_pos, read, memory_order_release);
+  }
+
+  if ((voice->position >> AUDIO_FRACTION_BITS) != 0 || buffered < 2) {
+    if (atomic_load_explicit(&stream->eof, memory_order_acquire)) {
+      internal_audio_finish(mixer, slot);
+    } else {
+      Metrics_CounterAdd(mixer->underrun_metric, 1);
+    }
+    return false;
+  }
+
+  uint64_t index = read & (AUDIO_STREAM_RING_FRAMES - 1);
+  uint64_t contiguous = AUDIO_STREAM_RING_FRAMES + AUDIO_STREAM_MIRROR_FRAMES - index;
+  *left = stream->left + index;
+  *right = stream->right + index;
+  *available = buffered < contiguous ? buffered : contiguous;
+  return true;
+}
+
+static void internal_audio_mix_voice(Audio_Mixer* mixer, const Audio_Kernels* kernels, int slot, int frames) {
+  Audio_VoiceState* voice = &mixer->voices[slot];
+  float step = (float)((double)voice->step / (double)(UINT64_C(1) << AUDIO_FRACTION_BITS));
+  int done = 0;
+
+  while (done < frames && voice->active) {
+    Audio_MixParams params;
+    uint64_t available;
+    if (!internal_audio_source(mixer, voice, slot, &params.src_l, &params.src_r, &available)) return;
+
+    // Output frames whose interpolation pair is inside the window.
+    params.frac = (float)((double)(voice->position & AUDIO_FRACTION_MASK) / (double)(UINT64_C(1) << AUDIO_FRACTION_BITS));
+    params.step = step;
+    int count = (int)ceil(((double)available - 1.0 - params.frac) / step);
+    if (count > frames - done) count = frames - done;
+    if (count <= 0) return;
+    if (voice->ramp_left > 0 && count > voice->ramp_left) count = voice->ramp_left;
+
+    params.gain_l = voice->gain_l;
+    params.gain_r = voice->gain_r;
+    params.gain_step_l = voice->ramp_left > 0 ? voice->step_l : 0.0f;
+    params.gain_step_r = voice->ramp_left > 0 ? voice->step_r : 0.0f;
+    kernels->mix(mixer->mix_l + done, mixer->mix_r + done, count, &params);
+
+    voice->position += voice->step * (uint64_t)count;
+    done += count;
+
+    if (voice->ramp_left > 0) {
+      voice->ramp_left -= count;
+      voice->gain_l += voice->step_l * (float)count;
+      voice->gain_r += voice->step_r * (float)count;
+      if (voice->ramp_left == 0) {
+        voice->gain_l = voice->target_l;
+        voice->gain_r = voice->target_r;
+        if (voice->stopping) internal_audio_finish(mixer, slot);
+      }
+    }
+  }
+}
+
+static void internal_audio_render(Audio_Mixer* mixer, float* out, int frames) {
+  Audio_Command command;
+  while (internal_audio_command_pop(&mixer->commands, &command)) internal_audio_apply(mixer, &command);
+
+  Audio_Kernels kernels = internal_audio_kernels();
+
+  while (frames > 0) {
+    int count = frames < AUDIO_CHUNK_FRAMES ? frames : AUDIO_CHUNK_FRAMES;
+    memset(mixer->mix_l, 0, (size_t)count * sizeof(float));
+    memset(mixer->mix_r, 0, (size_t)count * sizeof(float));
+
+    for (int slot = 0; slot < mixer->max_voices; slot++) {
+      if (mixer->voices[slot].active) internal_audio_mix_voice(mixer, &kernels, slot, count);
+    }
+
+    kernels.output(out, mixer->mix_l, mixer->mix_r, count);
+    out += 2 * count;
+    frames -= count;
+  }
+}
+
+static void SDLCALL internal_audio_callback(void* userdata, Uint8* stream, int len) {
+  Audio_Mixer* mixer = userdata;
+  uint64_t start = SDL_GetPerformanceCounter();
+
+  internal_audio_render(mixer, (float*)stream, len / (int)(2 * sizeof(float)));
+
+  uint64_t ns = (SDL_GetPerformanceCounter() - start) * UINT64_C(1000000000) / SDL_GetPerformanceFrequency();
+  atomic_fetch_add_explicit(&mixer->callback_count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&mixer->callback_ns, ns, memory_order_relaxed);
+  Metrics_HistogramObserve(mixer->callback_metric, (double)ns / 1.0e6);
+}
+
+
+/* ---- Mixer (game thread) ---- */
+
+static Audio_Mixer* internal_audio_create(const Audio_Config* config, bool open_device) {
+  Audio_Config defaults = {0};
+  if (!config) config = &defaults;
+
+  Audio_Mixer* mixer = calloc(1, sizeof(Audio_Mixer));
+  if (!mixer) return NULL;
+
+  mixer->frequency = config->frequency > 0 ? config->frequency : AUDIO_DEFAULT_FREQUENCY;
+  mixer->buffer_frames = config->buffer_frames > 0 ? config->buffer_frames : AUDIO_DEFAULT_BUFFER_FRAMES;
+  mixer->max_voices = config->max_voices > 0 ? config->max_voices : AUDIO_DEFAULT_MAX_VOICES;
+  if (mixer->max_voices > AUDIO_MAX_VOICES) mixer->max_voices = AUDIO_MAX_VOICES;
+
+  mixer->slots = calloc((size_t)mixer->max_voices, sizeof(Audio_Slot));
+  mixer->voices = calloc((size_t)mixer->max_voices, sizeof(Audio_VoiceState));
+  mixer->mix_l = aligned_alloc(AUDIO_ALIGNMENT, AUDIO_CHUNK_FRAMES * sizeof(float));
+  mixer->mix_r = aligned_alloc(AUDIO_ALIGNMENT, AUDIO_CHUNK_FRAMES * sizeof(float));
+  if (!mixer->slots || !mixer->voices || !mixer->mix_l || !mixer->mix_r) {
+    LOGGER_ERROR("Failed to allocate audio mixer\n");
+    Audio_Destroy(mixer);
+    return NULL;
+  }
+
+  mixer->callback_metric = Metrics_RegisterHistogram("audio_callback_ms",
+    (const double[]){ 0.1, 0.25, 0.5, 1.0, 2.0, 5.0, 10.0 }, 7);
+  mixer->underrun_metric = Metrics_RegisterCounter("audio_stream_underruns_total");
+  mixer->voices_metric = Metrics_RegisterGauge("audio_voices");
+
+  // Detect before the callback can run, so it never races the detection.
+  internal_audio_kernel();
+
+  pthread_mutex_init(&mixer->decoder_mutex, NULL);
+  pthread_cond_init(&mixer->decoder_cond, NULL);
+  mixer->decoder_running = true;
+  if (pthread_create(&mixer->decoder, NULL, internal_audio_decoder_main, mixer) != 0) {
+    LOGGER_ERROR("Failed to start audio decoder thread\n");
+    mixer->decoder_running = false;
+    Audio_Destroy(mixer);
+    return NULL;
+  }
+  mixer->decoder_started = true;
+
+  if (!open_device) return mixer;
+
+  SDL_AudioSpec wanted = {0};
+  wanted.freq = mixer->frequency;
+  wanted.format = AUDIO_F32SYS;
+  wanted.channels = 2;
+  wanted.samples = (Uint16)mixer->buffer_frames;
+  wanted.callback = internal_audio_callback;
+  wanted.userdata = mixer;
+
+  // No allowed changes: SDL converts to whatever the hardware takes, so the
+  // callback always sees float stereo at our rate.
+  SDL_AudioSpec obtained;
+  mixer->device = SDL_OpenAudioDevice(NULL, 0, &wanted, &obtained, 0);
+  if (mixer->device == 0) {
+    LOGGER_ERROR("SDL_OpenAudioDevice Error: %s\n", SDL_GetError());
+    Audio_Destroy(mixer);
+    return NULL;
+  }
+  mixer->buffer_frames = obtained.samples;
+
+  LOGGER_INFO("Audio: %s driver, %d Hz, %d frame buffers (%.1f ms)\n", SDL_GetCurrentAudioDriver(),
+    mixer->frequency, mixer->buffer_frames, mixer->buffer_frames * 1000.0 / mixer->frequency);
+
+  SDL_PauseAudioDevice(mixer->device, 0);
+  return mixer;
+}
+
+Audio_Mixer* Audio_Create(const Audio_Config* config) {
+  return internal_audio_create(config, true);
+}
+
+void Audio_Destroy(Audio_Mixer* mixer) {
+  if (!mixer) return;
+
+  // Closing waits for a running callback, after which nothing reads streams.
+  if (mixer->device) SDL_CloseAudioDevice(mixer->device);
+
+  if (mixer->decoder_started) {
+    pthread_mutex_lock(&mixer->decoder_mutex);
+    mixer->decoder_running = false;
+    pthread_cond_signal(&mixer->decoder_cond);
+    pthread_mutex_unlock(&mixer->decoder_mutex);
+    pthread_join(mixer->decoder, NULL);
+
+    pthread_mutex_destroy(&mixer->decoder_mutex);
+    pthread_cond_destroy(&mixer->decoder_cond);
+  }
+
+  while (mixer->streams) {
+    Audio_Stream* stream = mixer->streams;
+    mixer->streams = stream->next;
+    internal_audio_stream_free(stream);
+  }
+  while (mixer->incoming) {
+    Audio_Stream* stream = mixer->incoming;
+    mixer->incoming = stream->next;
+    internal_audio_stream_free(stream);
+  }
+
+  Metrics_GaugeAdd(mixer->voices_metric, -(int64_t)mixer->active_voices);
+
+  free(mixer->slots);
+  free(mixer->voices);
+  free(mixer->mix_l);
+  free(mixer->mix_r);
+  free(mixer);
+}
+
+static inline Audio_Voice internal_audio_handle(const Audio_Mixer* mixer, int slot) {
+  return (mixer->slots[slot].generation & 0xFFFFu) << 16 | (uint32_t)(slot + 1);
+}
+
+static int internal_audio_slot(const Audio_Mixer* mixer, Audio_Voice voice) {
+  int slot = (int)(voice & 0xFFFFu) - 1;
+  if (slot < 0 || slot >= mixer->max_voices) return -1;
+  if (!mixer->slots[slot].busy || (mixer->slots[slot].generation & 0xFFFFu) != voice >> 16) return -1;
+  return slot;
+}
+
+static inline int internal_audio_ms_to_frames(const Audio_Mixer* mixer, float ms) {
+  return ms > 0.0f ? (int)(ms * (float)mixer->frequency / 1000.0f) : 0;
+}
+
+static void internal_audio_release_slot(Audio_Mixer* mixer, int slot) {
+  Audio_Slot* entry = &mixer->slots[slot];
+
+  if (entry->stream) {
+    atomic_store_explicit(&entry->stream->closing, true, memory_order_release);
+    entry->stream = NULL;
+  }
+  entry->busy = false;
+  entry->generation++;
+  mixer->active_voices--;
+  Metrics_GaugeAdd(mixer->voices_metric, -1);
+}
+
+void Audio_Update(Audio_Mixer* mixer) {
+  if (!mixer) return;
+
+  int slot;
+  while (internal_audio_slot_pop(&mixer->finished, &slot)) internal_audio_release_slot(mixer, slot);
+}
+
+static Audio_Voice internal_audio_start(Audio_Mixer* mixer, const Audio_Sound* sound, Audio_Stream* stream,
+  int frequency, float volume, float pan, float pitch, bool loop) {
+  Audio_Update(mixer);
+
+  int slot = 0;
+  while (slot < mixer->max_voices && mixer->slots[slot].busy) slot++;
+  if (slot == mixer->max_voices) {
+    LOGGER_WARN("All %d audio voices are busy\n", mixer->max_voices);
+    return 0;
+  }
+
+  if (!(pitch > 0.0f)) pitch = 1.0f;
+  if (pitch > AUDIO_MAX_PITCH) pitch = AUDIO_MAX_PITCH;
+  double ratio = (double)frequency / (double)mixer->frequency * (double)pitch;
+
+  Audio_Command command = {0};
+  command.type = AUDIO_COMMAND_PLAY;
+  command.slot = slot;
+  command.generation = mixer->slots[slot].generation;
+  command.sound = sound;
+  command.stream = stream;
+  command.step = (uint64_t)(ratio * (double)(UINT64_C(1) << AUDIO_FRACTION_BITS) + 0.5);
+  command.loop = loop;
+  command.volume = volume;
+  command.pan = pan;
+  if (command.step == 0) command.step = 1;
+
+  if (!internal_audio_command_push(&mixer->commands, &command)) {
+    LOGGER_WARN("Audio command queue full, dropping voice\n");
+    return 0;
+  }
+
+  mixer->slots[slot].busy = true;
+  mixer->slots[slot].stream = stream;
+  mixer->active_voices++;
+  Metrics_GaugeAdd(mixer->voices_metric, 1);
+
+  return internal_audio_handle(mixer, slot);
+}
+
+Audio_Voice Audio_Play(Audio_Mixer* mixer, const Audio_Sound* sound, float volume, float pan, float pitch, bool loop) {
+  if (!mixer || !sound) return 0;
+  return internal_audio_start(mixer, sound, NULL, sound->frequency, volume, pan, pitch, loop);
+}
+
+Audio_Voice Audio_PlayStream(Audio_Mixer* mixer, const char* wav_path, float volume, bool loop) {
+  if (!mixer || !wav_path) return 0;
+
+  Audio_Stream* stream = internal_audio_stream_open(wav_path, loop);
+  if (!stream) return 0;
+
+  Audio_Voice voice = internal_audio_start(mixer, NULL, stream, stream->reader.frequency, volume, 0.0f, 1.0f, loop);
+  if (voice == 0) {
+    internal_audio_stream_free(stream);
+    return 0;
+  }
+
+  // The voice starts silent and picks up as soon as the decoder has data.
+  pthread_mutex_lock(&mixer->decoder_mutex);
+  stream->next = mixer->incoming;
+  mixer->incoming = stream;
+  pthread_cond_signal(&mixer->decoder_cond);
+  pthread_mutex_unlock(&mixer->decoder_mutex);
+
+  return voice;
+}
+
+static void internal_audio_send(Audio_Mixer* mixer, Audio_Voice voice, Audio_CommandType type,
+  float volume, float pan, float ramp_ms) {
+  if (!mixer) return;
+
+  int slot = internal_audio_slot(mixer, voice);
+  if (slot < 0) return;
+
+  Audio_Command command = {0};
+  command.type = type;
+  command.slot = slot;
+  command.generation = mixer->slots[slot].generation;
+  command.volume = volume;
+  command.pan = pan;
+  command.ramp_frames = internal_audio_ms_to_frames(mixer, ramp_ms);
+
+  if (!internal_audio_command_push(&mixer->commands, &command)) {
+    LOGGER_WARN("Audio command queue full, dropping command\n");
+  }
+}
+
+void Audio_SetVolume(Audio_Mixer* mixer, Audio_Voice voice, float volume, float ramp_ms) {
+  internal_audio_send(mixer, voice, AUDIO_COMMAND_VOLUME, volume, 0.0f, ramp_ms);
+}
+
+void Audio_SetPan(Audio_Mixer* mixer, Audio_Voice voice, float pan, float ramp_ms) {
+  internal_audio_send(mixer, voice, AUDIO_COMMAND_PAN, 0.0f, pan, ramp_ms);
+}
+
+void Audio_Stop(Audio_Mixer* mixer, Audio_Voice voice, float fade_ms) {
+  internal_audio_send(mixer, voice, AUDIO_COMMAND_STOP, 0.0f, 0.0f, fade_ms);
+}
+
+int Audio_GetActiveVoices(const Audio_Mixer* mixer) {
+  return mixer ? mixer->active_voices : 0;
+}
+
+int Audio_GetBufferFrames(const Audio_Mixer* mixer) {
+  return mixer ? mixer->buffer_frames : 0;
+}
+
+
+/* ---- Benchmark ---- */
+
+#define AUDIO_BENCH_VOICES 256
+#define AUDIO_BENCH_BUFFER_FRAMES 512
+#define AUDIO_BENCH_BUFFERS 400
+#define AUDIO_BENCH_SOUND_FRAMES 96000
+#define AUDIO_BENCH_LIVE_MS 500
+
+static double internal_audio_bench_ms(uint64_t start) {
+  return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+static void internal_audio_bench_run(Audio_Mixer* mixer, Audio_Kernel kernel, const char* label, float* out) {
+  Audio_Kernel detected = internal_audio_kernel();
+  g_kernel = kernel;
+
+  uint64_t start = SDL_GetPerformanceCounter();
+  for (int b = 0; b < AUDIO_BENCH_BUFFERS; b++) internal_audio_render(mixer, out, AUDIO_BENCH_BUFFER_FRAMES);
+  double ms = internal_audio_bench_ms(start);
+
+  // One voice mixed means one voice through one whole buffer.
+  double buffer_ms = AUDIO_BENCH_BUFFER_FRAMES * 1000.0 / mixer->frequency;
+  double voices_per_ms = (double)AUDIO_BENCH_VOICES * AUDIO_BENCH_BUFFERS / ms;
+  static const char* const names[] = { "scalar", "SSE2", "AVX2" };
+  LOGGER_INFO("Audio %-6s %-9s: %9.0f voices/ms, %.1f us per buffer, %5.0f voices in real time\n",
+    names[kernel], label, voices_per_ms, ms * 1000.0 / AUDIO_BENCH_BUFFERS, voices_per_ms * buffer_ms);
+
+  g_kernel = detected;
+}
+
+static void internal_audio_bench_voices(Audio_Mixer* mixer, const Audio_Sound* sound, float pitch) {
+  for (int v = 0; v < AUDIO_BENCH_VOICES; v++) {
+    float pan = (float)(v % 17) / 8.0f - 1.0f;
+    Audio_Play(mixer, sound, 0.5f / AUDIO_BENCH_VOICES, pan, pitch, true);
+  }
+}
+
+static void internal_audio_bench_stop(Audio_Mixer* mixer, float* out) {
+  for (int slot = 0; slot < mixer->max_voices; slot++) {
+    if (mixer->slots[slot].busy) Audio_Stop(mixer, internal_audio_handle(mixer, slot), 0.0f);
+  }
+  internal_audio_render(mixer, out, 1);
+  Audio_Update(mixer);
+}
+
+void Audio_Benchmark(void) {
+  // Real time playback needs a device; the dummy driver consumes buffers at
+  // the hardware pace without making a sound, the disk driver writes a file.
+  bool own_subsystem = !SDL_WasInit(SDL_INIT_AUDIO);
+  if (own_subsystem && SDL_AudioInit("dummy") != 0 && SDL_AudioInit("disk") != 0) {
+    LOGGER_WARN("No dummy or disk audio driver (%s), benchmarking without a device\n", SDL_GetError());
+  }
+  bool have_driver = SDL_GetCurrentAudioDriver() != NULL;
+
+  float* samples = malloc(AUDIO_BENCH_SOUND_FRAMES * 2 * sizeof(float));
+  float* out = malloc(AUDIO_BENCH_BUFFER_FRAMES * 2 * sizeof(float));
+  Audio_Config config = { AUDIO_DEFAULT_FREQUENCY, AUDIO_BENCH_BUFFER_FRAMES, AUDIO_BENCH_VOICES };
+  Audio_Mixer* mixer = samples && out ? internal_audio_create(&config, have_driver) : NULL;
+  if (!mixer) {
+    LOGGER_ERROR("Failed to allocate audio benchmark resources\n");
+    free(samples);
+    free(out);
+    if (own_subsystem && have_driver) SDL_AudioQuit();
+    return;
+  }
+
+  for (int i = 0; i < AUDIO_BENCH_SOUND_FRAMES; i++) {
+    samples[2 * i] = sinf((float)i * 0.0575f);
+    samples[2 * i + 1] = sinf((float)i * 0.0311f);
+  }
+  Audio_Sound* native = Audio_CreateSound(samples, AUDIO_BENCH_SOUND_FRAMES, 2, AUDIO_DEFAULT_FREQUENCY);
+  Audio_Sound* resampled = Audio_CreateSound(samples, AUDIO_BENCH_SOUND_FRAMES, 2, 44100);
+
+  LOGGER_INFO("Audio benchmark: %d voices, %d frame buffers at %d Hz\n",
+    AUDIO_BENCH_VOICES, AUDIO_BENCH_BUFFER_FRAMES, mixer->frequency);
+
+  if (mixer->device) {
+    internal_audio_bench_voices(mixer, resampled, 1.0f);
+    SDL_Delay(AUDIO_BENCH_LIVE_MS);
+    SDL_PauseAudioDevice(mixer->device, 1);
+
+    uint64_t callbacks = atomic_load(&mixer->callback_count);
+    double callback_us = callbacks ? (double)atomic_load(&mixer->callback_ns) / 1000.0 / callbacks : 0.0;
+    double buffer_us = mixer->buffer_frames * 1.0e6 / mixer->frequency;
+    LOGGER_INFO("Audio %s driver: %llu callbacks in %d ms, %.1f us each (%.2f%% of a buffer)\n",
+      SDL_GetCurrentAudioDriver(), (unsigned long long)callbacks, AUDIO_BENCH_LIVE_MS, callback_us,
+      callback_us / buffer_us * 100.0);
+
+    internal_audio_bench_stop(mixer, out);
+  }
+
+  // The device is paused from here on, so rendering directly cannot race it.
+  Audio_Kernel detected = internal_audio_kernel();
+  const Audio_Sound* sounds[] = { native, resampled };
+  const char* labels[] = { "native", "resampled" };
+
+  for (int s = 0; s < 2; s++) {
+    if (!sounds[s]) continue;
+
+    internal_audio_bench_voices(mixer, sounds[s], 1.0f);
+    internal_audio_bench_run(mixer, AUDIO_KERNEL_SCALAR, labels[s], out);
+    if (detected != AUDIO_KERNEL_SCALAR) internal_audio_bench_run(mixer, detected, labels[s], out);
+    internal_audio_bench_stop(mixer, out);
+  }
+
+  Audio_Destroy(mixer);
+  Audio_DestroySound(native);
+  Audio_DestroySound(resampled);
+  free(samples);
+  free(out);
+  if (own_subsystem && have_driver) SDL_AudioQuit();
+}
@@ -0,0 +1,638 @@
+#define _GNU_SOURCE
+
+#include <engine/coro/coro.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <SDL2/SDL.h>
+
+// The hand-written switch only saves what the SysV ABI says a callee keeps,
+// which is far cheaper than swapcontext's signal mask syscall. Build with
+// -DCORO_FORCE_UCONTEXT to compare, or on other targets.
+#if defined(__x86_64__) && !defined(_WIN32) && !defined(CORO_FORCE_UCONTEXT)
+#define CORO_ASM_SWITCH 1
+#else
+#define CORO_ASM_SWITCH 0
+#include <ucontext.h>
+#endif
+
+#define CORO_DEFAULT_STACK_SIZE (64 * 1024)
+#define CORO_MIN_STACK_SIZE (8 * 1024)
+#define CORO_SLAB_STACKS 64
+#define CORO_POLL_INTERVAL_MS 4
+
+typedef enum {
+  CORO_STATE_FREE,
+  CORO_STATE_READY,
+  CORO_STATE_RUNNING,
+  CORO_STATE_NEXT_FRAME,
+  CORO_STATE_TIMER,
+  CORO_STATE_JOBS,
+  CORO_STATE_EVENT,
+  CORO_STATE_DONE
+} Coro_State;
+
+typedef struct Coro Coro;
+
+// Lives at the top of its own stack, so a coroutine costs no allocation
+// beyond its stack slot.
+struct Coro {
+#if CORO_ASM_SWITCH
+  void* sp;
+#else
+  ucontext_t context;
+#endif
+  Coro_Scheduler* scheduler;
+  Coro_Function function;
+  void* data;
+  Coro_State state;
+
+  Timer_Wheel* wheel;
+  Timer_Handle timer;
+  Jobs_Counter* counter;
+  Coro_Event* event;
+
+  Coro* next; // Ready, next-frame, polled or free list
+};
+
+typedef struct {
+  Coro* head;
+  Coro* tail;
+} Coro_Queue;
+
+struct Coro_Scheduler {
+#if CORO_ASM_SWITCH
+  void* sp;
+#else
+  ucontext_t context;
+#endif
+
+  size_t page_size;
+  size_t stack_size; // Usable bytes, excluding the guard page
+  size_t slot_size;  // Guard page plus stack
+
+  unsigned char** slabs;
+  int slab_count;
+  int slab_capacity;
+  bool guards_failed;
+  int guarded;
+
+  Coro* free_list;
+  Coro_Queue ready;
+  Coro_Queue next_frame;
+  Coro* polled; // Waiting on jobs or events, checked once per frame
+
+  int live;
+
+  Metrics_Gauge* live_metric;
+  Metrics_Gauge* memory_metric;
+  Metrics_Gauge* guarded_metric;
+  Metrics_Gauge* unguarded_metric;
+};
+
+static _Thread_local Coro* t_current = NULL;
+
+/* ---- Context switch ---- */
+
+#if CORO_ASM_SWITCH
+
+// internal_coro_switch(void** save_sp, void* load_sp): pushes the callee-saved
+// registers, parks the stack pointer in *save_sp, then pops the other
+// context's registers and returns into it.
+__asm__(
+  ".text\n"
+  ".p2align 4\n"
+  ".globl internal_coro_switch\n"
+  ".hidden internal_coro_switch\n"
+  ".type internal_coro_switch, @function\n"
+  "internal_coro_switch:\n"
+  "  pushq %rbp\n"
+  "  pushq %rbx\n"
+  "  pushq %r12\n"
+  "  pushq %r13\n"
+  "  pushq %r14\n"
+  "  pushq %r15\n"
+  "  movq %rsp, (%rdi)\n"
+  "  movq %rsi, %rsp\n"
+  "  popq %r15\n"
+  "  popq %r14\n"
+  "  popq %r13\n"
+  "  popq %r12\n"
+  "  popq %rbx\n"
+  "  popq %rbp\n"
+  "  ret\n"
+  ".size internal_coro_switch, .-internal_coro_switch\n"
+);
+
+void internal_coro_switch(void** save_sp, void* load_sp);
+
+#endif
+
+static void internal_coro_entry(void);
+
+static void internal_coro_prepare(Coro* coro) {
+#if CORO_ASM_SWITCH
+  // Frame as if internal_coro_switch had been called from the entry point:
+  // six zeroed registers, then the return address. The entry sees the stack
+  // aligned like any freshly called function.
+  void** sp = (void**)((uintptr_t)coro & ~(uintptr_t)15);
+  *--sp = NULL; // Return address of the entry, which never returns
+  *--sp = (void*)(uintptr_t)internal_coro_entry;
+  for (int i = 0; i < 6; i++) *--sp = NULL;
+  coro->sp = sp;
+#else
+  Coro_Scheduler* scheduler = coro->scheduler;
+  unsigned char* stack = (unsigned char*)coro + sizeof(Coro) - scheduler->stack_size;
+
+  getcontext(&coro->context);
+  coro->context.uc_stack.ss_sp = stack;
+  coro->context.uc_stack.ss_size = (size_t)((unsigned char*)coro - stack);
+  coro->context.uc_link = NULL;
+  makecontext(&coro->context, internal_coro_entry, 0);
+#endif
+}
+
+static void internal_coro_resume(Coro* coro) {
+  Coro_Scheduler* scheduler = coro->scheduler;
+
+  t_current = coro;
+  coro->state = CORO_STATE_RUNNING;
+#if CORO_ASM_SWITCH
+  internal_coro_switch(&scheduler->sp, coro->sp);
+#else
+  swapcontext(&scheduler->context, &coro->context);
+#endif
+  t_current = NULL;
+}
+
+static void internal_coro_suspend(Coro* coro) {
+#if CORO_ASM_SWITCH
+  internal_coro_switch(&coro->sp, coro->scheduler->sp);
+#else
+  swapcontext(&coro->context, &coro->scheduler->context);
+#endif
+}
+
+static void internal_coro_entry(void) {
+  Coro* coro = t_current;
+  coro->function(coro->data);
+
+  coro->state = CORO_STATE_DONE;
+  internal_coro_suspend(coro);
+
+  // A finished coroutine is never resumed.
+  abort();
+}
+
+/* ---- Queues ---- */
+
+static void internal_coro_push(Coro_Queue* queue, Coro* coro) {
+  coro->next = NULL;
+  if (queue->tail) {
+    queue->tail->next = coro;
+  } else {
+    queue->head = coro;
+  }
+  queue->tail = coro;
+}
+
+static Coro* internal_coro_pop(Coro_Queue* queue) {
+  Coro* coro = queue->head;
+  if (!coro) return NULL;
+
+  queue->head = coro->next;
+  if (!queue->head) queue->tail = NULL;
+  return coro;
+}
+
+static void internal_coro_splice(Coro_Queue* queue, Coro_Queue* other) {
+  if (!other->head) return;
+
+  if (queue->tail) {
+    queue->tail->next = other->head;
+  } else {
+    queue->head = other->head;
+  }
+  queue->tail = other->tail;
+  other->head = NULL;
+  other->tail = NULL;
+}
+
+/* ---- Stack pool ---- */
+
+static inline Coro* internal_coro_in_slot(const Coro_Scheduler* scheduler, unsigned char* slot) {
+  return (Coro*)(slot + scheduler->slot_size - sizeof(Coro));
+}
+
+static bool internal_coro_grow(Coro_Scheduler* scheduler) {
+  if (scheduler->slab_count == scheduler->slab_capacity) {
+    int capacity = scheduler->slab_capacity ? scheduler->slab_capacity * 2 : 16;
+    unsigned char** slabs = realloc(scheduler->slabs, (size_t)capacity * sizeof(unsigned char*));
+    if (!slabs) return false;
+
+    scheduler->slabs = slabs;
+    scheduler->slab_capacity = capacity;
+  }
+
+  size_t bytes = scheduler->slot_size * CORO_SLAB_STACKS;
+  unsigned char* slab = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (slab == MAP_FAILED) {
+    LOGGER_ERROR("Failed to map %zu bytes of coroutine stacks\n", bytes);
+    return false;
+  }
+  scheduler->slabs[scheduler->slab_count++] = slab;
+
+  // Walk backwards so the free list hands out the lowest slot first.
+  for (int i = CORO_SLAB_STACKS - 1; i >= 0; i--) {
+    unsigned char* slot = slab + (size_t)i * scheduler->slot_size;
+
+    // Every guard splits the mapping, and the kernel caps mappings per
+    // process (vm.max_map_count). Past that cap stacks go unguarded.
+    bool guarded = false;
+    if (!scheduler->guards_failed) {
+      if (mprotect(slot, scheduler->page_size, PROT_NONE) == 0) {
+        guarded = true;
+        scheduler->guarded++;
+      } else {
+        scheduler->guards_failed = true;
+        LOGGER_WARN("Coroutine guard pages unavailable after %d stacks, further stacks are unguarded\n",
+          scheduler->guarded);
+      }
+    }
+    Metrics_GaugeAdd(guarded ? scheduler->guarded_metric : scheduler->unguarded_metric, 1);
+
+    Coro* coro = internal_coro_in_slot(scheduler, slot);
+    coro->scheduler = scheduler;
+    coro->state = CORO_STATE_FREE;
+    coro->next = scheduler->free_list;
+    scheduler->free_list = coro;
+  }
+
+  Metrics_GaugeAdd(scheduler->memory_metric, (int64_t)bytes);
+  return true;
+}
+
+static Coro* internal_coro_acquire(Coro_Scheduler* scheduler, Coro_Function function, void* data) {
+  if (!scheduler->free_list && !internal_coro_grow(scheduler)) return NULL;
+
+  Coro* coro = scheduler->free_list;
+  scheduler->free_list = coro->next;
+
+  coro->function = function;
+  coro->data = data;
+  coro->state = CORO_STATE_READY;
+  coro->wheel = NULL;
+  coro->timer = 0;
+  coro->counter = NULL;
+  coro->event = NULL;
+  coro->next = NULL;
+  internal_coro_prepare(coro);
+
+  scheduler->live++;
+  Metrics_GaugeAdd(scheduler->live_metric, 1);
+  return coro;
+}
+
+static void internal_coro_release(Coro_Scheduler* scheduler, Coro* coro) {
+  coro->state = CORO_STATE_FREE;
+  coro->next = scheduler->free_list;
+  scheduler->free_list = coro;
+
+  scheduler->live--;
+  Metrics_GaugeAdd(scheduler->live_metric, -1);
+}
+
+/* ---- Scheduler ---- */
+
+Coro_Scheduler* Coro_CreateScheduler(size_t stack_size) {
+  long page = sysconf(_SC_PAGESIZE);
+  size_t page_size = page > 0 ? (size_t)page : 4096;
+
+  if (stack_size == 0) stack_size = CORO_DEFAULT_STACK_SIZE;
+  if (stack_size < CORO_MIN_STACK_SIZE) stack_size = CORO_MIN_STACK_SIZE;
+  stack_size = (stack_size + page_size - 1) & ~(page_size - 1);
+
+  Coro_Scheduler* scheduler = calloc(1, sizeof(Coro_Scheduler));
+  if (!scheduler) return NULL;
+
+  scheduler->page_size = page_size;
+  scheduler->stack_size = stack_size;
+  scheduler->slot_size = page_size + stack_size;
+
+  scheduler->live_metric = Metrics_RegisterGauge("coro_live");
+  scheduler->memory_metric = Metrics_RegisterGauge("memory_coro_stack_bytes");
+  scheduler->guarded_metric = Metrics_RegisterGauge("coro_stacks_guarded");
+  scheduler->unguarded_metric = Metrics_RegisterGauge("coro_stacks_unguarded");
+
+  return scheduler;
+}
+
+void Coro_DestroyScheduler(Coro_Scheduler* scheduler) {
+  if (!scheduler) return;
+
+  if (t_current && t_current->scheduler == scheduler) {
+    LOGGER_ERROR("Coro_DestroyScheduler called from one of its own coroutines\n");
+    return;
+  }
+
+  // Jobs started by Coro_RunBlocking decrement a counter on the waiting
+  // coroutine's stack, so they must finish before the slabs go away.
+  for (Coro* coro = scheduler->polled; coro; coro = coro->next) {
+    if (coro->state == CORO_STATE_JOBS) Jobs_Wait(coro->counter);
+  }
+
+  size_t bytes = scheduler->slot_size * CORO_SLAB_STACKS;
+  for (int s = 0; s < scheduler->slab_count; s++) {
+    for (int i = 0; i < CORO_SLAB_STACKS; i++) {
+      Coro* coro = internal_coro_in_slot(scheduler, scheduler->slabs[s] + (size_t)i * scheduler->slot_size);
+      // The wheel would otherwise call back into an unmapped stack.
+      if (coro->state == CORO_STATE_TIMER) Timer_Cancel(coro->wheel, coro->timer);
+    }
+    munmap(scheduler->slabs[s], bytes);
+  }
+
+  if (scheduler->live > 0) {
+    LOGGER_DEBUG("Dropped %d suspended coroutines\n", scheduler->live);
+  }
+  Metrics_GaugeAdd(scheduler->live_metric, -(int64_t)scheduler->live);
+  Metrics_GaugeAdd(scheduler->memory_metric, -(int64_t)(bytes * (size_t)scheduler->slab_count));
+  Metrics_GaugeAdd(scheduler->guarded_metric, -(int64_t)scheduler->guarded);
+  Metrics_GaugeAdd(scheduler->unguarded_metric, -(int64_t)(CORO_SLAB_STACKS * scheduler->slab_count - scheduler->guarded));
+
+  free(scheduler->slabs);
+  free(scheduler);
+}
+
+bool Coro_Spawn(Coro_Scheduler* scheduler, Coro_Function function, void* data) {
+  if (!scheduler || !function) return false;
+
+  Coro* coro = internal_coro_acquire(scheduler, function, data);
+  if (!coro) return false;
+
+  internal_coro_push(&scheduler->ready, coro);
+  return true;
+}
+
+static bool internal_coro_poll(Coro* coro) {
+  if (coro->state == CORO_STATE_JOBS) return Jobs_IsDone(coro->counter);
+  return Coro_IsSignaled(coro->event);
+}
+
+void Coro_RunFrame(Coro_Scheduler* scheduler) {
+  if (!scheduler) return;
+
+  if (t_current) {
+    LOGGER_ERROR("Coro_RunFrame called from inside a coroutine\n");
+    return;
+  }
+
+  // Coroutines that waited for this frame run after those woken by timers.
+  internal_coro_splice(&scheduler->ready, &scheduler->next_frame);
+
+  Coro** link = &scheduler->polled;
+  while (*link) {
+    Coro* coro = *link;
+    if (internal_coro_poll(coro)) {
+      *link = coro->next;
+      coro->state = CORO_STATE_READY;
+      internal_coro_push(&scheduler->ready, coro);
+    } else {
+      link = &coro->next;
+    }
+  }
+
+  // Anything suspending again lands on another list, so this drains.
+  Coro* coro;
+  while ((coro = internal_coro_pop(&scheduler->ready))) {
+    internal_coro_resume(coro);
+    if (coro->state == CORO_STATE_DONE) internal_coro_release(scheduler, coro);
+  }
+}
+
+int Coro_GetLiveCount(const Coro_Scheduler* scheduler) {
+  return scheduler ? scheduler->live : 0;
+}
+
+int Coro_NextWakeIn(const Coro_Scheduler* scheduler, int max_ms) {
+  if (!scheduler) return max_ms;
+
+  if (scheduler->ready.head || scheduler->next_frame.head) return 0;
+  if (scheduler->polled) return max_ms < CORO_POLL_INTERVAL_MS ? max_ms : CORO_POLL_INTERVAL_MS;
+  return max_ms;
+}
+
+bool Coro_WantsFrame(const Coro_Scheduler* scheduler) {
+  return scheduler && scheduler->next_frame.head != NULL;
+}
+
+/* ---- Awaitables ---- */
+
+static Coro* internal_coro_current(const char* awaitable) {
+  if (!t_current) LOGGER_ERROR("%s called outside a coroutine\n", awaitable);
+  return t_current;
+}
+
+void Coro_NextFrame(void) {
+  Coro* coro = internal_coro_current("Coro_NextFrame");
+  if (!coro) return;
+
+  coro->state = CORO_STATE_NEXT_FRAME;
+  internal_coro_push(&coro->scheduler->next_frame, coro);
+  internal_coro_suspend(coro);
+}
+
+static void internal_coro_timer_fired(void* data) {
+  Coro* coro = data;
+
+  coro->timer = 0;
+  coro->state = CORO_STATE_READY;
+  internal_coro_push(&coro->scheduler->ready, coro);
+}
+
+void Coro_WaitTimer(Timer_Wheel* wheel, uint64_t delay_ms) {
+  Coro* coro = internal_coro_current("Coro_WaitTimer");
+  if (!coro) return;
+
+  coro->state = CORO_STATE_TIMER;
+  coro->wheel = wheel;
+  coro->timer = Timer_Schedule(wheel, delay_ms, 0, internal_coro_timer_fired, coro);
+  if (coro->timer == 0) {
+    LOGGER_WARN("Failed to schedule coroutine timer, resuming next frame instead\n");
+    Coro_NextFrame();
+    return;
+  }
+  internal_coro_suspend(coro);
+}
+
+static void internal_coro_wait_polled(Coro* coro, Coro_State state) {
+  coro->state = state;
+  coro->next = coro->scheduler->polled;
+  coro->scheduler->polled = coro;
+  internal_coro_suspend(coro);
+}
+
+void Coro_WaitJobs(Jobs_Counter* counter) {
+  Coro* coro = internal_coro_current("Coro_WaitJobs");
+  if (!coro || Jobs_IsDone(counter)) return;
+
+  coro->counter = counter;
+  internal_coro_wait_polled(coro, CORO_STATE_JOBS);
+}
+
+void Coro_WaitEvent(Coro_Event* event) {
+  Coro* coro = internal_coro_current("Coro_WaitEvent");
+  if (!coro || Coro_IsSignaled(event)) return;
+
+  coro->event = event;
+  internal_coro_wait_polled(coro, CORO_STATE_EVENT);
+}
+
+void Coro_RunBlocking(Jobs_Function function, void* data) {
+  if (!internal_coro_current("Coro_RunBlocking")) return;
+
+  // The counter lives on this coroutine's stack, which stays put while it
+  // is suspended.
+  Jobs_Counter counter = {0};
+  Jobs_Submit(function, data, &counter);
+  Coro_WaitJobs(&counter);
+}
+
+void Coro_Signal(Coro_Event* event) {
+  atomic_store_explicit(&event->signaled, 1, memory_order_release);
+}
+
+void Coro_ResetEvent(Coro_Event* event) {
+  atomic_store_explicit(&event->signaled, 0, memory_order_relaxed);
+}
+
+bool Coro_IsSignaled(Coro_Event* event) {
+  return atomic_load_explicit(&event->signaled, memory_order_acquire) != 0;
+}
+
+bool Coro_InCoroutine(void) {
+  return t_current != NULL;
+}
+
+/* ---- Benchmark ---- */
+
+#define CORO_BENCH_STACK_SIZE (16 * 1024)
+#define CORO_BENCH_SWITCHES 1000000
+#define CORO_BENCH_LIVE 100000
+#define CORO_BENCH_FRAMES 20
+#define CORO_BENCH_SLEEP_MS (60u * 60u * 1000u)
+
+typedef struct {
+  Timer_Wheel* wheel;
+  int frames;
+} Coro_BenchContext;
+
+static double internal_coro_bench_ns(uint64_t start) {
+  return (double)(SDL_GetPerformanceCounter() - start) * 1.0e9 / SDL_GetPerformanceFrequency();
+}
+
+static void internal_coro_bench_pingpong(void* data) {
+  int count = *(int*)data;
+  for (int i = 0; i < count; i++) internal_coro_suspend(t_current);
+}
+
+static void internal_coro_bench_idle(void* data) {
+  Coro_BenchContext* context = data;
+
+  Coro_WaitTimer(context->wheel, CORO_BENCH_SLEEP_MS);
+  for (int i = 0; i < context->frames; i++) Coro_NextFrame();
+}
+
+static size_t internal_coro_resident_bytes(const Coro_Scheduler* scheduler) {
+  size_t bytes = scheduler->slot_size * CORO_SLAB_STACKS;
+  size_t pages = bytes / scheduler->page_size;
+  unsigned char* residency = malloc(pages);
+  if (!residency) return 0;
+
+  size_t resident = 0;
+  for (int s = 0; s < scheduler->slab_count; s++) {
+    if (mincore(scheduler->slabs[s], bytes, residency) != 0) continue;
+    for (size_t p = 0; p < pages; p++) resident += residency[p] & 1;
+  }
+
+  free(residency);
+  return resident * scheduler->page_size;
+}
+
+void Coro_Benchmark(void) {
+  Coro_Scheduler* scheduler = Coro_CreateScheduler(CORO_BENCH_STACK_SIZE);
+  Timer_Wheel* wheel = Timer_CreateWheel(CORO_BENCH_LIVE);
+  if (!scheduler || !wheel) {
+    LOGGER_ERROR("Failed to allocate coroutine benchmark resources\n");
+    Timer_DestroyWheel(wheel);
+    Coro_DestroyScheduler(scheduler);
+    return;
+  }
+
+  // Raw switch cost: one coroutine bounced back and forth without the
+  // scheduler's queues in between.
+  int switches = CORO_BENCH_SWITCHES;
+  Coro* pingpong = internal_coro_acquire(scheduler, internal_coro_bench_pingpong, &switches);
+  if (!pingpong) {
+    LOGGER_ERROR("Failed to allocate coroutine benchmark resources\n");
+    Timer_DestroyWheel(wheel);
+    Coro_DestroyScheduler(scheduler);
+    return;
+  }
+
+  uint64_t start = SDL_GetPerformanceCounter();
+  for (int i = 0; i <= switches; i++) internal_coro_resume(pingpong);
+  double switch_ns = internal_coro_bench_ns(start) / (2.0 * switches + 2.0);
+  internal_coro_release(scheduler, pingpong);
+
+  // Many live coroutines parked on a timer, then all woken and yielding
+  // every frame.
+  Coro_BenchContext context = { wheel, CORO_BENCH_FRAMES };
+
+  start = SDL_GetPerformanceCounter();
+  int spawned = 0;
+  while (spawned < CORO_BENCH_LIVE && Coro_Spawn(scheduler, internal_coro_bench_idle, &context)) spawned++;
+  double spawn_ns = internal_coro_bench_ns(start) / (spawned ? spawned : 1);
+
+  start = SDL_GetPerformanceCounter();
+  Coro_RunFrame(scheduler);
+  double park_ms = internal_coro_bench_ns(start) / 1.0e6;
+
+  start = SDL_GetPerformanceCounter();
+  Coro_RunFrame(scheduler);
+  double idle_us = internal_coro_bench_ns(start) / 1000.0;
+
+  int live = Coro_GetLiveCount(scheduler);
+  size_t resident = internal_coro_resident_bytes(scheduler);
+  size_t reserved = scheduler->slot_size * CORO_SLAB_STACKS * (size_t)scheduler->slab_count;
+
+  Timer_Advance(wheel, CORO_BENCH_SLEEP_MS);
+  Coro_RunFrame(scheduler); // Back from the timer, into the first frame wait
+
+  start = SDL_GetPerformanceCounter();
+  for (int frame = 1; frame < CORO_BENCH_FRAMES; frame++) Coro_RunFrame(scheduler);
+  double frame_ms = internal_coro_bench_ns(start) / 1.0e6 / (CORO_BENCH_FRAMES - 1);
+
+  Coro_RunFrame(scheduler); // Every coroutine returns
+  int left = Coro_GetLiveCount(scheduler);
+
+  LOGGER_INFO("Coroutine benchmark: %s switch, %zu KB stacks, %d/%d stacks guarded\n",
+    CORO_ASM_SWITCH ? "x86_64 asm" : "ucontext", scheduler->stack_size / 1024,
+    scheduler->guarded, CORO_SLAB_STACKS * scheduler->slab_count);
+  LOGGER_INFO("Coroutine switch : %.1f ns (%d round trips)\n", switch_ns, switches);
+  LOGGER_INFO("Coroutine spawn  : %.1f ns/coroutine with pool growth, first run to park %.2f ms for %d\n", spawn_ns, park_ms, spawned);
+  LOGGER_INFO("Coroutine idle   : %d live, %.1f us/frame, %.0f bytes resident each (%.0f reserved)\n",
+    live, idle_us, live ? (double)resident / live : 0.0, live ? (double)reserved / live : 0.0);
+  LOGGER_INFO("Coroutine active : %.2f ms/frame with %d yielding, %.1f ns per resume and yield on cold stacks\n",
+    frame_ms, live, live ? frame_ms * 1.0e6 / live : 0.0);
+  LOGGER_INFO("Coroutine finish : %d left\n", left);
+
+  Coro_DestroyScheduler(scheduler);
+  Timer_DestroyWheel(wheel);
+}
@@ -0,0 +1,221 @@
+#include <engine/input/input.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+#define INPUT_BATCH_SIZE 64
+#define INPUT_LATENCY_SAMPLES 1024
+
+struct Input_State {
+  Input_Snapshot snapshot;
+  bool presented; // The snapshot's input already has a latency sample
+
+  float latency_ms[INPUT_LATENCY_SAMPLES]; // Ring of the newest samples
+  int latency_count;
+  int latency_next;
+
+  Metrics_Counter* events_metric;
+  Metrics_Histogram* latency_metric;
+};
+
+Input_State* Input_Create(void) {
+  Input_State* input = calloc(1, sizeof(Input_State));
+  if (!input) return NULL;
+
+  static const double latency_bounds[] = { 2.0, 4.0, 8.0, 16.7, 25.0, 33.3, 50.0, 100.0 };
+  input->events_metric = Metrics_RegisterCounter("input_events_total");
+  input->latency_metric = Metrics_RegisterHistogram("input_latency_ms", latency_bounds,
+    (int)(sizeof(latency_bounds) / sizeof(latency_bounds[0])));
+
+  return input;
+}
+
+void Input_Destroy(Input_State* input) {
+  free(input);
+}
+
+// SDL stamps events in whole milliseconds of SDL_GetTicks. Back-date the
+// drain time by the event's age in the queue, never past the drain itself.
+static uint64_t internal_input_event_time(uint32_t timestamp, uint64_t drained, uint32_t drained_ticks, uint64_t frequency) {
+  uint32_t age_ms = drained_ticks - timestamp;
+  if (timestamp == 0 || age_ms > drained_ticks) return drained; // Unstamped, or from the future
+
+  uint64_t age = (uint64_t)age_ms * frequency / 1000;
+  return age < drained ? drained - age : drained;
+}
+
+static inline void internal_input_set_bit(uint64_t* bits, int index, bool value) {
+  if (value) {
+    bits[index >> 6] |= UINT64_C(1) << (index & 63);
+  } else {
+    bits[index >> 6] &= ~(UINT64_C(1) << (index & 63));
+  }
+}
+
+static void internal_input_key(Input_Snapshot* snapshot, const SDL_KeyboardEvent* key, bool down) {
+  int scancode = (int)key->keysym.scancode;
+  if (key->repeat || scancode < 0 || scancode >= INPUT_KEY_COUNT) return;
+
+  internal_input_set_bit(down ? snapshot->keys_pressed : snapshot->keys_released, scancode, true);
+  internal_input_set_bit(snapshot->keys_down, scancode, down);
+}
+
+static void internal_input_button(Input_Snapshot* snapshot, const SDL_MouseButtonEvent* button, bool down) {
+  if (button->button < 1 || button->button > 32) return;
+
+  uint32_t bit = UINT32_C(1) << (button->button - 1);
+  if (down) {
+    snapshot->buttons_pressed |= bit;
+    snapshot->buttons_down |= bit;
+  } else {
+    snapshot->buttons_released |= bit;
+    snapshot->buttons_down &= ~bit;
+  }
+  snapshot->mouse_x = button->x;
+  snapshot->mouse_y = button->y;
+}
+
+static void internal_input_text(Input_Snapshot* snapshot, const char* text) {
+  int length = (int)strlen(text);
+
+  // Whole events only, so a UTF-8 sequence is never cut in half.
+  if (snapshot->text_length + length >= INPUT_TEXT_SIZE) return;
+
+  memcpy(snapshot->text + snapshot->text_length, text, (size_t)length + 1);
+  snapshot->text_length += length;
+}
+
+// Returns true for events that count towards input latency.
+static bool internal_input_fold(Input_Snapshot* snapshot, const SDL_Event* event) {
+  switch (event->type) {
+    case SDL_QUIT:
+      snapshot->quit_requested = true;
+      return false;
+    case SDL_RENDER_DEVICE_RESET:
+      snapshot->device_reset = true;
+      snapshot->window_changed = true;
+      return false;
+    case SDL_WINDOWEVENT:
+    case SDL_RENDER_TARGETS_RESET:
+      snapshot->window_changed = true;
+      return false;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+      internal_input_key(snapshot, &event->key, event->type == SDL_KEYDOWN);
+      return !event->key.repeat;
+    case SDL_TEXTINPUT:
+      internal_input_text(snapshot, event->text.text);
+      return true;
+    case SDL_MOUSEMOTION:
+      snapshot->mouse_x = event->motion.x;
+      snapshot->mouse_y = event->motion.y;
+      snapshot->mouse_dx += event->motion.xrel;
+      snapshot->mouse_dy += event->motion.yrel;
+      return true;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+      internal_input_button(snapshot, &event->button, event->type == SDL_MOUSEBUTTONDOWN);
+      return true;
+    case SDL_MOUSEWHEEL: {
+      int sign = event->wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1 : 1;
+      snapshot->wheel_x += event->wheel.x * sign;
+      snapshot->wheel_y += event->wheel.y * sign;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+const Input_Snapshot* Input_Poll(Input_State* input) {
+  if (!input) return NULL;
+
+  // Held state carries over; edges, deltas and text are per frame.
+  Input_Snapshot* snapshot = &input->snapshot;
+  memset(snapshot->keys_pressed, 0, sizeof(snapshot->keys_pressed));
+  memset(snapshot->keys_released, 0, sizeof(snapshot->keys_released));
+  snapshot->buttons_pressed = 0;
+  snapshot->buttons_released = 0;
+  snapshot->mouse_dx = snapshot->mouse_dy = 0;
+  snapshot->wheel_x = snapshot->wheel_y = 0;
+  snapshot->text[0] = '\0';
+  snapshot->text_length = 0;
+  snapshot->quit_requested = false;
+  snapshot->window_changed = false;
+  snapshot->device_reset = false;
+  snapshot->event_count = 0;
+  snapshot->oldest_input = 0;
+  input->presented = false;
+
+  SDL_PumpEvents();
+
+  uint64_t drained = SDL_GetPerformanceCounter();
+  uint32_t drained_ticks = SDL_GetTicks();
+  uint64_t frequency = SDL_GetPerformanceFrequency();
+
+  SDL_Event batch[INPUT_BATCH_SIZE];
+  int count;
+  while ((count = SDL_PeepEvents(batch, INPUT_BATCH_SIZE, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)) > 0) {
+    for (int i = 0; i < count; i++) {
+      if (!internal_input_fold(snapshot, &batch[i])) continue;
+
+      uint64_t time = internal_input_event_time(batch[i].common.timestamp, drained, drained_ticks, frequency);
+      if (snapshot->oldest_input == 0 || time < snapshot->oldest_input) snapshot->oldest_input = time;
+    }
+    snapshot->event_count += count;
+
+    if (count < INPUT_BATCH_SIZE) break;
+  }
+
+  if (count < 0) LOGGER_ERROR("SDL_PeepEvents Error: %s\n", SDL_GetError());
+  Metrics_CounterAdd(input->events_metric, (uint64_t)snapshot->event_count);
+
+  return snapshot;
+}
+
+const Input_Snapshot* Input_GetSnapshot(const Input_State* input) {
+  return input ? &input->snapshot : NULL;
+}
+
+void Input_MarkPresented(Input_State* input) {
+  if (!input || input->presented || input->snapshot.oldest_input == 0) return;
+
+  double ms = (double)(SDL_GetPerformanceCounter() - input->snapshot.oldest_input) * 1000.0 / SDL_GetPerformanceFrequency();
+  input->presented = true;
+
+  input->latency_ms[input->latency_next] = (float)ms;
+  input->latency_next = (input->latency_next + 1) % INPUT_LATENCY_SAMPLES;
+  if (input->latency_count < INPUT_LATENCY_SAMPLES) input->latency_count++;
+
+  Metrics_HistogramObserve(input->latency_metric, ms);
+}
+
+static int internal_input_compare(const void* a, const void* b) {
+  float x = *(const float*)a;
+  float y = *(const float*)b;
+  return (x > y) - (x < y);
+}
+
+Input_LatencyStats Input_GetLatency(const Input_State* input) {
+  Input_LatencyStats stats = {0};
+  if (!input || input->latency_count == 0) return stats;
+
+  float sorted[INPUT_LATENCY_SAMPLES];
+  int count = input->latency_count;
+  memcpy(sorted, input->latency_ms, (size_t)count * sizeof(float));
+  qsort(sorted, (size_t)count, sizeof(float), internal_input_compare);
+
+  // Nearest-rank percentiles.
+  stats.samples = count;
+  stats.p50_ms = sorted[(count - 1) * 50 / 100];
+  stats.p95_ms = sorted[(count - 1) * 95 / 100];
+  stats.p99_ms = sorted[(count - 1) * 99 / 100];
+  stats.max_ms = sorted[count - 1];
+  return stats;
+}
@@ -0,0 +1,255 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <engine/jobs/jobs.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <SDL2/SDL.h>
+
+#define JOBS_QUEUE_CAPACITY 4096
+#define JOBS_MAX_WORKERS 64
+#define JOBS_MAX_BATCHES 256
+
+typedef struct {
+  Jobs_Function function;
+  void* data;
+  Jobs_Counter* counter;
+} Jobs_Entry;
+
+typedef struct {
+  Jobs_RangeFunction function;
+  void* data;
+  int begin;
+  int end;
+} Jobs_RangeEntry;
+
+static Jobs_Entry g_queue[JOBS_QUEUE_CAPACITY];
+static int g_queue_head = 0;
+static int g_queue_count = 0;
+
+static pthread_t g_workers[JOBS_MAX_WORKERS];
+// g_worker_count and g_is_stopping are guarded by g_jobs_mutex.
+// g_is_initialized only changes under it too, but is also read lock-free
+// on the submit path.
+static int g_worker_count = 0;
+static atomic_bool g_is_initialized = false;
+static bool g_is_stopping = false;
+
+static pthread_mutex_t g_jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_jobs_cond = PTHREAD_COND_INITIALIZER;
+
+static Metrics_Gauge* g_queue_depth_metric = NULL;
+static Metrics_Counter* g_executed_metric = NULL;
+
+static bool internal_jobs_pop(Jobs_Entry* out) {
+  if (g_queue_count == 0) return false;
+
+  *out = g_queue[g_queue_head];
+  g_queue_head = (g_queue_head + 1) % JOBS_QUEUE_CAPACITY;
+  g_queue_count--;
+  Metrics_GaugeAdd(g_queue_depth_metric, -1);
+  return true;
+}
+
+static void internal_jobs_run(const Jobs_Entry* entry) {
+  entry->function(entry->data);
+  Metrics_CounterAdd(g_executed_metric, 1);
+  if (entry->counter != NULL) {
+    atomic_fetch_sub_explicit(&entry->counter->pending, 1, memory_order_release);
+  }
+}
+
+static void *internal_jobs_worker(void* arg) {
+  (void)arg;
+  Jobs_Entry entry;
+
+  pthread_mutex_lock(&g_jobs_mutex);
+  while (true) {
+    while (!g_is_stopping && g_queue_count == 0) {
+      pthread_cond_wait(&g_jobs_cond, &g_jobs_mutex);
+    }
+    if (g_is_stopping && g_queue_count == 0) break;
+
+    internal_jobs_pop(&entry);
+    pthread_mutex_unlock(&g_jobs_mutex);
+
+    internal_jobs_run(&entry);
+
+    pthread_mutex_lock(&g_jobs_mutex);
+  }
+  pthread_mutex_unlock(&g_jobs_mutex);
+
+  return NULL;
+}
+
+static void internal_jobs_lazy_init(void) {
+  if (!atomic_load_explicit(&g_is_initialized, memory_order_acquire)) Jobs_Init(0);
+}
+
+bool Jobs_Init(int worker_count) {
+  pthread_mutex_lock(&g_jobs_mutex);
+
+  // Any Submit or ParallelFor before this call already started the default
+  // pool; an explicit count it does not match is not honoured.
+  if (atomic_load_explicit(&g_is_initialized, memory_order_relaxed)) {
+    int running = g_worker_count;
+    pthread_mutex_unlock(&g_jobs_mutex);
+
+    int requested = worker_count > JOBS_MAX_WORKERS ? JOBS_MAX_WORKERS : worker_count;
+    if (worker_count > 0 && requested != running) {
+      LOGGER_WARN("Jobs_Init(%d) ignored, the job system already runs %d workers\n", worker_count, running);
+      return false;
+    }
+    return true;
+  }
+
+  g_queue_depth_metric = Metrics_RegisterGauge("jobs_queue_depth");
+  g_executed_metric = Metrics_RegisterCounter("jobs_executed_total");
+
+  if (worker_count <= 0) worker_count = SDL_GetCPUCount() - 1;
+  if (worker_count > JOBS_MAX_WORKERS) worker_count = JOBS_MAX_WORKERS;
+  if (worker_count < 0) worker_count = 0;
+
+  g_is_stopping = false;
+  g_worker_count = 0;
+  for (int i = 0; i < worker_count; i++) {
+    if (pthread_create(&g_workers[i], NULL, internal_jobs_worker, NULL) != 0) {
+      LOGGER_WARN("Failed to start job worker %d, continuing with %d workers\n", i, g_worker_count);
+      break;
+    }
+    g_worker_count++;
+  }
+
+  int started = g_worker_count;
+  atomic_store_explicit(&g_is_initialized, true, memory_order_release);
+  pthread_mutex_unlock(&g_jobs_mutex);
+
+  LOGGER_INFO("Job system started with %d workers\n", started);
+  return true;
+}
+
+void Jobs_Destroy(void) {
+  pthread_mutex_lock(&g_jobs_mutex);
+
+  // A concurrent Destroy already owns the shutdown.
+  if (!atomic_load_explicit(&g_is_initialized, memory_order_relaxed) || g_is_stopping) {
+    pthread_mutex_unlock(&g_jobs_mutex);
+    return;
+  }
+
+  // From here on Submit runs jobs inline instead of queueing them for
+  // workers that are about to exit; the workers drain what is queued.
+  g_is_stopping = true;
+  int worker_count = g_worker_count;
+  pthread_cond_broadcast(&g_jobs_cond);
+  pthread_mutex_unlock(&g_jobs_mutex);
+
+  for (int i = 0; i < worker_count; i++) {
+    pthread_join(g_workers[i], NULL);
+  }
+
+  pthread_mutex_lock(&g_jobs_mutex);
+  g_worker_count = 0;
+  g_is_stopping = false;
+  atomic_store_explicit(&g_is_initialized, false, memory_order_release);
+  pthread_mutex_unlock(&g_jobs_mutex);
+  LOGGER_INFO("Job system stopped.\n");
+}
+
+int Jobs_GetWorkerCount(void) {
+  internal_jobs_lazy_init();
+
+  pthread_mutex_lock(&g_jobs_mutex);
+  int worker_count = g_worker_count;
+  pthread_mutex_unlock(&g_jobs_mutex);
+  return worker_count;
+}
+
+void Jobs_Submit(Jobs_Function function, void* data, Jobs_Counter* counter) {
+  internal_jobs_lazy_init();
+
+  Jobs_Entry entry = { function, data, counter };
+  if (counter != NULL) atomic_fetch_add_explicit(&counter->pending, 1, memory_order_relaxed);
+
+  pthread_mutex_lock(&g_jobs_mutex);
+
+  // No workers to hand it to, workers shutting down, or the queue is
+  // saturated: run it right here.
+  if (g_worker_count == 0 || g_is_stopping || g_queue_count == JOBS_QUEUE_CAPACITY) {
+    pthread_mutex_unlock(&g_jobs_mutex);
+    internal_jobs_run(&entry);
+    return;
+  }
+
+  g_queue[(g_queue_head + g_queue_count) % JOBS_QUEUE_CAPACITY] = entry;
+  g_queue_count++;
+  Metrics_GaugeAdd(g_queue_depth_metric, 1);
+  pthread_cond_signal(&g_jobs_cond);
+
+  pthread_mutex_unlock(&g_jobs_mutex);
+}
+
+bool Jobs_IsDone(Jobs_Counter* counter) {
+  return atomic_load_explicit(&counter->pending, memory_order_acquire) <= 0;
+}
+
+void Jobs_Wait(Jobs_Counter* counter) {
+  Jobs_Entry entry;
+
+  while (!Jobs_IsDone(counter)) {
+    pthread_mutex_lock(&g_jobs_mutex);
+    bool has_entry = internal_jobs_pop(&entry);
+    pthread_mutex_unlock(&g_jobs_mutex);
+
+    if (has_entry) {
+      internal_jobs_run(&entry);
+    } else {
+      sched_yield();
+    }
+  }
+}
+
+static void internal_jobs_run_range(void* data) {
+  Jobs_RangeEntry* range = data;
+  range->function(range->begin, range->end, range->data);
+}
+
+void Jobs_ParallelFor(int count, int min_batch, Jobs_RangeFunction function, void* data) {
+  if (count <= 0) return;
+  if (min_batch < 1) min_batch = 1;
+
+  int workers = Jobs_GetWorkerCount();
+  int batches = count / min_batch;
+  if (batches > (workers + 1) * 4) batches = (workers + 1) * 4;
+  if (batches > JOBS_MAX_BATCHES) batches = JOBS_MAX_BATCHES;
+
+  if (workers == 0 || batches <= 1) {
+    function(0, count, data);
+    return;
+  }
+
+  Jobs_RangeEntry ranges[JOBS_MAX_BATCHES];
+  Jobs_Counter counter = { 0 };
+  int per_batch = count / batches;
+  int remainder = count % batches;
+  int begin = 0;
+
+  for (int i = 0; i < batches; i++) {
+    int size = per_batch + (i < remainder ? 1 : 0);
+    ranges[i] = (Jobs_RangeEntry){ function, data, begin, begin + size };
+    begin += size;
+  }
+
+  // The caller keeps the first batch for itself.
+  for (int i = 1; i < batches; i++) {
+    Jobs_Submit(internal_jobs_run_range, &ranges[i], &counter);
+  }
+  internal_jobs_run_range(&ranges[0]);
+
+  Jobs_Wait(&counter);
+}
@@ -1,6 +1,7 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include <engine/logger.h> 
+#include <engine/metrics/metrics.h>
 
 #include <time.h>   
 #include <stdio.h>  
@@ -25,6 +26,10 @@ static char *g_log_format = NULL;
 static pthread_mutex_t g_log_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool g_is_initialized = false;
 
+// queue_depth counts callers waiting on or holding the log mutex.
+static Metrics_Gauge *g_queue_depth_metric = NULL;
+static Metrics_Counter *g_lines_metric = NULL;
+
 static void internal_logger_lazy_init(void);
 
 const char *log_level_name(Logger_Level level) {
@@ -73,6 +78,9 @@ static void internal_logger_lazy_init(void) {
   }
 
   g_log_level = DEFAULT_LEVEL;
+
+  if (g_queue_depth_metric == NULL) g_queue_depth_metric = Metrics_RegisterGauge("logger_queue_depth");
+  if (g_lines_metric == NULL) g_lines_metric = Metrics_RegisterCounter("logger_lines_total");
     
   g_log_format = strdup(DEFAULT_FORMAT_STR);
   if (g_log_format == NULL) {
@@ -262,11 +270,13 @@ void Logger_RootLog(Logger_Level level, const char* file, const char* format, ..
     return;
   }
 
+  Metrics_GaugeAdd(g_queue_depth_metric, 1);
   pthread_mutex_lock(&g_log_mutex);
 
   if (!g_is_initialized || (g_console_ptr == NULL && g_logfile_ptr == NULL)) {
     fprintf(stderr, "LOGGER ERROR: Logger not ready to log (no active output streams).\n");
     pthread_mutex_unlock(&g_log_mutex);
+    Metrics_GaugeAdd(g_queue_depth_metric, -1);
     return;
   }
 
@@ -278,6 +288,7 @@ void Logger_RootLog(Logger_Level level, const char* file, const char* format, ..
 
   if (formatted_user_message == NULL) {
     pthread_mutex_unlock(&g_log_mutex);
+    Metrics_GaugeAdd(g_queue_depth_metric, -1);
     return;
   }
 
@@ -315,4 +326,6 @@ void Logger_RootLog(Logger_Level level, const char* file, const char* format, ..
   formatted_user_message = NULL;
 
   pthread_mutex_unlock(&g_log_mutex);
+  Metrics_GaugeAdd(g_queue_depth_metric, -1);
+  Metrics_CounterAdd(g_lines_metric, 1);
 }
\ No newline at end of file
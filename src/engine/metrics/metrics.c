@@ -0,0 +1,436 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <engine/metrics/metrics.h>
+#include <engine/logger.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#define METRICS_MAX 128
+#define METRICS_SHARDS 16
+#define METRICS_NAME_SIZE 64
+#define METRICS_CACHE_LINE 64
+#define METRICS_SERVER_POLL_MS 200
+
+typedef enum {
+  METRICS_KIND_COUNTER,
+  METRICS_KIND_GAUGE,
+  METRICS_KIND_HISTOGRAM
+} Metrics_Kind;
+
+// One cache line per shard, so threads on different shards never share a line.
+typedef struct {
+  _Alignas(METRICS_CACHE_LINE) atomic_uint_fast64_t value;
+} Metrics_CounterShard;
+
+typedef struct {
+  _Alignas(METRICS_CACHE_LINE) atomic_int_fast64_t value;
+} Metrics_GaugeShard;
+
+typedef struct {
+  _Alignas(METRICS_CACHE_LINE) atomic_uint_fast64_t counts[METRICS_MAX_BUCKETS + 1];
+  atomic_uint_fast64_t sum_bits; // double, updated with a CAS loop
+} Metrics_HistogramShard;
+
+struct Metrics_Counter {
+  Metrics_CounterShard shards[METRICS_SHARDS];
+};
+
+struct Metrics_Gauge {
+  Metrics_GaugeShard shards[METRICS_SHARDS];
+};
+
+struct Metrics_Histogram {
+  double bounds[METRICS_MAX_BUCKETS];
+  int bound_count;
+  Metrics_HistogramShard shards[METRICS_SHARDS];
+};
+
+typedef struct {
+  char name[METRICS_NAME_SIZE];
+  Metrics_Kind kind;
+  union {
+    Metrics_Counter counter;
+    Metrics_Gauge gauge;
+    Metrics_Histogram histogram;
+  } as;
+} Metrics_Entry;
+
+// Entries are only ever appended. g_metric_count is published with release
+// ordering, so readers can walk the table without taking the mutex.
+static Metrics_Entry* g_metrics[METRICS_MAX];
+static atomic_int g_metric_count = 0;
+static pthread_mutex_t g_metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_int g_next_shard = 0;
+static _Thread_local int t_shard = -1;
+
+static inline int internal_metrics_shard(void) {
+  if (t_shard < 0) t_shard = atomic_fetch_add_explicit(&g_next_shard, 1, memory_order_relaxed) % METRICS_SHARDS;
+  return t_shard;
+}
+
+// Registration reports problems on stderr rather than through the logger,
+// because the logger registers its own metrics. Histogram bounds are filled
+// in before the entry is published; a re-registration keeps the original ones.
+static Metrics_Entry* internal_metrics_register(const char* name, Metrics_Kind kind, const double* bounds, int bound_count) {
+  if (name == NULL || strlen(name) >= METRICS_NAME_SIZE) {
+    fprintf(stderr, "METRICS ERROR: Invalid metric name.\n");
+    return NULL;
+  }
+
+  pthread_mutex_lock(&g_metrics_mutex);
+
+  int count = atomic_load_explicit(&g_metric_count, memory_order_relaxed);
+  for (int i = 0; i < count; i++) {
+    if (strcmp(g_metrics[i]->name, name) == 0) {
+      Metrics_Entry* existing = g_metrics[i]->kind == kind ? g_metrics[i] : NULL;
+      pthread_mutex_unlock(&g_metrics_mutex);
+      if (!existing) fprintf(stderr, "METRICS ERROR: Metric %s already registered with another kind.\n", name);
+      return existing;
+    }
+  }
+
+  if (count == METRICS_MAX) {
+    pthread_mutex_unlock(&g_metrics_mutex);
+    fprintf(stderr, "METRICS ERROR: Metric registry full, dropping %s.\n", name);
+    return NULL;
+  }
+
+  size_t size = (sizeof(Metrics_Entry) + METRICS_CACHE_LINE - 1) / METRICS_CACHE_LINE * METRICS_CACHE_LINE;
+  Metrics_Entry* entry = aligned_alloc(METRICS_CACHE_LINE, size);
+  if (!entry) {
+    pthread_mutex_unlock(&g_metrics_mutex);
+    fprintf(stderr, "METRICS ERROR: Failed to allocate metric %s.\n", name);
+    return NULL;
+  }
+
+  memset(entry, 0, size);
+  strcpy(entry->name, name);
+  entry->kind = kind;
+  if (kind == METRICS_KIND_HISTOGRAM && bound_count > 0) {
+    memcpy(entry->as.histogram.bounds, bounds, (size_t)bound_count * sizeof(double));
+    entry->as.histogram.bound_count = bound_count;
+  }
+
+  g_metrics[count] = entry;
+  atomic_store_explicit(&g_metric_count, count + 1, memory_order_release);
+
+  pthread_mutex_unlock(&g_metrics_mutex);
+  return entry;
+}
+
+Metrics_Counter* Metrics_RegisterCounter(const char* name) {
+  Metrics_Entry* entry = internal_metrics_register(name, METRICS_KIND_COUNTER, NULL, 0);
+  return entry ? &entry->as.counter : NULL;
+}
+
+Metrics_Gauge* Metrics_RegisterGauge(const char* name) {
+  Metrics_Entry* entry = internal_metrics_register(name, METRICS_KIND_GAUGE, NULL, 0);
+  return entry ? &entry->as.gauge : NULL;
+}
+
+Metrics_Histogram* Metrics_RegisterHistogram(const char* name, const double* bounds, int bound_count) {
+  if (bound_count < 0 || bound_count > METRICS_MAX_BUCKETS) {
+    fprintf(stderr, "METRICS ERROR: Histogram %s needs 0 to %d bucket bounds.\n", name, METRICS_MAX_BUCKETS);
+    return NULL;
+  }
+
+  Metrics_Entry* entry = internal_metrics_register(name, METRICS_KIND_HISTOGRAM, bounds, bound_count);
+  return entry ? &entry->as.histogram : NULL;
+}
+
+
+/* ---- Updates ---- */
+
+void Metrics_CounterAdd(Metrics_Counter* counter, uint64_t amount) {
+  if (!counter) return;
+  atomic_fetch_add_explicit(&counter->shards[internal_metrics_shard()].value, amount, memory_order_relaxed);
+}
+
+void Metrics_GaugeAdd(Metrics_Gauge* gauge, int64_t delta) {
+  if (!gauge) return;
+  atomic_fetch_add_explicit(&gauge->shards[internal_metrics_shard()].value, delta, memory_order_relaxed);
+}
+
+// A gauge is the sum of its shards, so setting it adds the difference to the
+// caller's shard. Concurrent Set calls on one gauge are last-writer-wins at best.
+void Metrics_GaugeSet(Metrics_Gauge* gauge, int64_t value) {
+  if (!gauge) return;
+  Metrics_GaugeAdd(gauge, value - Metrics_GaugeRead(gauge));
+}
+
+void Metrics_HistogramObserve(Metrics_Histogram* histogram, double value) {
+  if (!histogram) return;
+
+  int bucket = 0;
+  while (bucket < histogram->bound_count && value > histogram->bounds[bucket]) bucket++;
+
+  Metrics_HistogramShard* shard = &histogram->shards[internal_metrics_shard()];
+  atomic_fetch_add_explicit(&shard->counts[bucket], 1, memory_order_relaxed);
+
+  union { uint64_t bits; double value; } old_sum, new_sum;
+  old_sum.bits = atomic_load_explicit(&shard->sum_bits, memory_order_relaxed);
+  do {
+    new_sum.value = old_sum.value + value;
+  } while (!atomic_compare_exchange_weak_explicit(&shard->sum_bits, &old_sum.bits, new_sum.bits, memory_order_relaxed, memory_order_relaxed));
+}
+
+
+/* ---- Reads ---- */
+
+uint64_t Metrics_CounterRead(const Metrics_Counter* counter) {
+  if (!counter) return 0;
+
+  uint64_t total = 0;
+  for (int i = 0; i < METRICS_SHARDS; i++) {
+    total += atomic_load_explicit(&((Metrics_Counter*)counter)->shards[i].value, memory_order_relaxed);
+  }
+  return total;
+}
+
+int64_t Metrics_GaugeRead(const Metrics_Gauge* gauge) {
+  if (!gauge) return 0;
+
+  int64_t total = 0;
+  for (int i = 0; i < METRICS_SHARDS; i++) {
+    total += atomic_load_explicit(&((Metrics_Gauge*)gauge)->shards[i].value, memory_order_relaxed);
+  }
+  return total;
+}
+
+int64_t Metrics_SumGauges(const char* prefix) {
+  if (!prefix) return 0;
+
+  size_t prefix_length = strlen(prefix);
+  int count = atomic_load_explicit(&g_metric_count, memory_order_acquire);
+  int64_t total = 0;
+  for (int i = 0; i < count; i++) {
+    const Metrics_Entry* entry = g_metrics[i];
+    if (entry->kind == METRICS_KIND_GAUGE && strncmp(entry->name, prefix, prefix_length) == 0) {
+      total += Metrics_GaugeRead(&entry->as.gauge);
+    }
+  }
+  return total;
+}
+
+uint64_t Metrics_HistogramRead(const Metrics_Histogram* histogram, uint64_t* counts_out, double* sum_out) {
+  if (!histogram) return 0;
+
+  Metrics_Histogram* h = (Metrics_Histogram*)histogram;
+  uint64_t total = 0;
+  double sum = 0.0;
+
+  if (counts_out) memset(counts_out, 0, (size_t)(h->bound_count + 1) * sizeof(uint64_t));
+
+  for (int i = 0; i < METRICS_SHARDS; i++) {
+    for (int b = 0; b <= h->bound_count; b++) {
+      uint64_t count = atomic_load_explicit(&h->shards[i].counts[b], memory_order_relaxed);
+      if (counts_out) counts_out[b] += count;
+      total += count;
+    }
+
+    union { uint64_t bits; double value; } shard_sum;
+    shard_sum.bits = atomic_load_explicit(&h->shards[i].sum_bits, memory_order_relaxed);
+    sum += shard_sum.value;
+  }
+
+  if (sum_out) *sum_out = sum;
+  return total;
+}
+
+
+/* ---- Text dump ---- */
+
+static void internal_metrics_appendf(char* buffer, size_t size, size_t* length, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+
+  char* out = (buffer && *length < size) ? buffer + *length : NULL;
+  size_t room = (buffer && *length < size) ? size - *length : 0;
+  int written = vsnprintf(out, room, format, args);
+
+  va_end(args);
+  if (written > 0) *length += (size_t)written;
+}
+
+size_t Metrics_Format(char* buffer, size_t size) {
+  size_t length = 0;
+  int count = atomic_load_explicit(&g_metric_count, memory_order_acquire);
+
+  if (buffer && size > 0) buffer[0] = '\0';
+
+  for (int i = 0; i < count; i++) {
+    const Metrics_Entry* entry = g_metrics[i];
+
+    switch (entry->kind) {
+      case METRICS_KIND_COUNTER:
+        internal_metrics_appendf(buffer, size, &length, "# TYPE %s counter\n%s %llu\n",
+          entry->name, entry->name, (unsigned long long)Metrics_CounterRead(&entry->as.counter));
+        break;
+
+      case METRICS_KIND_GAUGE:
+        internal_metrics_appendf(buffer, size, &length, "# TYPE %s gauge\n%s %lld\n",
+          entry->name, entry->name, (long long)Metrics_GaugeRead(&entry->as.gauge));
+        break;
+
+      case METRICS_KIND_HISTOGRAM: {
+        const Metrics_Histogram* h = &entry->as.histogram;
+        uint64_t counts[METRICS_MAX_BUCKETS + 1];
+        double sum;
+        uint64_t total = Metrics_HistogramRead(h, counts, &sum);
+        uint64_t cumulative = 0;
+
+        internal_metrics_appendf(buffer, size, &length, "# TYPE %s histogram\n", entry->name);
+        for (int b = 0; b < h->bound_count; b++) {
+          cumulative += counts[b];
+          internal_metrics_appendf(buffer, size, &length, "%s_bucket{le=\"%g\"} %llu\n",
+            entry->name, h->bounds[b], (unsigned long long)cumulative);
+        }
+        internal_metrics_appendf(buffer, size, &length, "%s_bucket{le=\"+Inf\"} %llu\n%s_sum %g\n%s_count %llu\n",
+          entry->name, (unsigned long long)total, entry->name, sum, entry->name, (unsigned long long)total);
+        break;
+      }
+    }
+  }
+
+  return length;
+}
+
+
+/* ---- Inspection server ---- */
+
+#ifndef _WIN32
+
+static int g_server_fd = -1;
+static char* g_server_path = NULL;
+static pthread_t g_server_thread;
+static atomic_bool g_server_stopping = false;
+
+static void internal_metrics_serve_client(int client) {
+  size_t needed = Metrics_Format(NULL, 0) + 1;
+  char* dump = malloc(needed);
+  if (!dump) return;
+
+  size_t length = Metrics_Format(dump, needed);
+  if (length >= needed) length = needed - 1;
+
+#ifdef MSG_NOSIGNAL
+  int flags = MSG_NOSIGNAL;
+#else
+  int flags = 0;
+#endif
+
+  size_t sent = 0;
+  while (sent < length) {
+    ssize_t n = send(client, dump + sent, length - sent, flags);
+    if (n <= 0) break;
+    sent += (size_t)n;
+  }
+
+  free(dump);
+}
+
+static void *internal_metrics_server(void* arg) {
+  (void)arg;
+
+  while (!atomic_load(&g_server_stopping)) {
+    struct pollfd listener = { g_server_fd, POLLIN, 0 };
+    if (poll(&listener, 1, METRICS_SERVER_POLL_MS) <= 0) continue;
+
+    int client = accept(g_server_fd, NULL, NULL);
+    if (client < 0) continue;
+
+    internal_metrics_serve_client(client);
+    close(client);
+  }
+
+  return NULL;
+}
+
+bool Metrics_StartServer(const char* socket_path) {
+  if (g_server_fd >= 0) return true;
+
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if (socket_path == NULL || strlen(socket_path) >= sizeof(address.sun_path)) {
+    LOGGER_ERROR("Metrics socket path is missing or too long\n");
+    return false;
+  }
+  strcpy(address.sun_path, socket_path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    LOGGER_ERROR("Failed to create metrics socket\n");
+    return false;
+  }
+
+  // A stale socket from a crashed run would make bind fail.
+  unlink(socket_path);
+  if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 4) != 0) {
+    LOGGER_ERROR("Failed to bind metrics socket: %s\n", socket_path);
+    close(fd);
+    return false;
+  }
+
+  g_server_fd = fd;
+  atomic_store(&g_server_stopping, false);
+
+  if (pthread_create(&g_server_thread, NULL, internal_metrics_server, NULL) != 0) {
+    LOGGER_ERROR("Failed to start metrics server thread\n");
+    close(fd);
+    unlink(socket_path);
+    g_server_fd = -1;
+    return false;
+  }
+  g_server_path = strdup(socket_path);
+
+  LOGGER_INFO("Metrics available on %s\n", socket_path);
+  return true;
+}
+
+void Metrics_StopServer(void) {
+  if (g_server_fd < 0) return;
+
+  atomic_store(&g_server_stopping, true);
+  pthread_join(g_server_thread, NULL);
+
+  close(g_server_fd);
+  g_server_fd = -1;
+
+  if (g_server_path != NULL) {
+    unlink(g_server_path);
+    free(g_server_path);
+    g_server_path = NULL;
+  }
+
+  LOGGER_INFO("Metrics server stopped.\n");
+}
+
+#else
+
+bool Metrics_StartServer(const char* socket_path) {
+  (void)socket_path;
+  LOGGER_WARN("Metrics server is not supported on this platform\n");
+  return false;
+}
+
+void Metrics_StopServer(void) {
+}
+
+#endif
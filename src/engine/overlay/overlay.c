@@ -0,0 +1,399 @@
+#include <engine/overlay/overlay.h>
+#include <engine/profiler/profiler.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <SDL2/SDL.h>
+
+#define OVERLAY_FIRST_GLYPH 32 // The font covers ' ' to '_'; lowercase draws as uppercase
+#define OVERLAY_GLYPH_COUNT 64
+#define OVERLAY_GLYPH_WIDTH 5
+#define OVERLAY_GLYPH_HEIGHT 7
+#define OVERLAY_ATLAS_CELL 8 // Transparent padding keeps neighbouring glyphs from bleeding
+#define OVERLAY_ATLAS_COLUMNS 16
+#define OVERLAY_ATLAS_WIDTH (OVERLAY_ATLAS_COLUMNS * OVERLAY_ATLAS_CELL)
+#define OVERLAY_ATLAS_HEIGHT (OVERLAY_GLYPH_COUNT / OVERLAY_ATLAS_COLUMNS * OVERLAY_ATLAS_CELL)
+
+#define OVERLAY_SCALE 2.0f
+#define OVERLAY_ADVANCE (6 * OVERLAY_SCALE)
+#define OVERLAY_LINE_HEIGHT (9 * OVERLAY_SCALE)
+#define OVERLAY_LINE_SIZE 64
+#define OVERLAY_MARGIN 8.0f
+#define OVERLAY_PADDING 6.0f
+
+#define OVERLAY_HISTORY 240 // Frames in the graph
+#define OVERLAY_GRAPH_WIDTH 360.0f
+#define OVERLAY_GRAPH_HEIGHT 60.0f
+#define OVERLAY_GRAPH_MAX_MS 50.0
+#define OVERLAY_TOP_ZONES 6
+
+#define OVERLAY_MAX_GLYPHS 512
+#define OVERLAY_MAX_SHAPES (OVERLAY_HISTORY + 8) // Panel, graph background, bars and budget lines
+#define OVERLAY_MAX_QUADS (OVERLAY_MAX_GLYPHS > OVERLAY_MAX_SHAPES ? OVERLAY_MAX_GLYPHS : OVERLAY_MAX_SHAPES)
+
+// 5x7 glyphs from OVERLAY_FIRST_GLYPH on, one byte per row, bit 4 leftmost.
+static const uint8_t OVERLAY_FONT[OVERLAY_GLYPH_COUNT][OVERLAY_GLYPH_HEIGHT] = {
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+  { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // '!'
+  { 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 }, // '"'
+  { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // '#'
+  { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // '$'
+  { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // '%'
+  { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // '&'
+  { 0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, // "'"
+  { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // '('
+  { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // ')'
+  { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // '*'
+  { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // '+'
+  { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ','
+  { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // '-'
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // '.'
+  { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // '/'
+  { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // '0'
+  { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // '1'
+  { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // '2'
+  { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // '3'
+  { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // '4'
+  { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // '5'
+  { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // '6'
+  { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // '7'
+  { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // '8'
+  { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // '9'
+  { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+  { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ';'
+  { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // '<'
+  { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // '='
+  { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // '>'
+  { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // '?'
+  { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // '@'
+  { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 'A'
+  { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // 'B'
+  { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // 'C'
+  { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // 'D'
+  { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 'E'
+  { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // 'F'
+  { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // 'G'
+  { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'H'
+  { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 'I'
+  { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // 'J'
+  { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // 'K'
+  { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // 'L'
+  { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // 'M'
+  { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // 'N'
+  { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'O'
+  { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // 'P'
+  { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // 'Q'
+  { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // 'R'
+  { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // 'S'
+  { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // 'T'
+  { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'U'
+  { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'V'
+  { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // 'W'
+  { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // 'X'
+  { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // 'Y'
+  { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // 'Z'
+  { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // '['
+  { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // '\\'
+  { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ']'
+  { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // '^'
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // '_'
+};
+
+struct Overlay {
+  SDL_Renderer* renderer;
+  SDL_Texture* atlas;
+  bool visible;
+
+  float frame_ms[OVERLAY_HISTORY]; // Ring of the newest frames
+  int frame_next;
+  int frame_count;
+  int draw_calls; // Of the newest frame
+
+  // Rebuilt every visible frame. Quad indices never change.
+  SDL_Vertex* shapes;
+  int shape_count;
+  SDL_Vertex* glyphs;
+  int glyph_count;
+  int* indices;
+
+  Profiler_Zone* zone;
+  Metrics_Gauge* log_queue_metric;
+};
+
+static const SDL_Color OVERLAY_PANEL_COLOR = { 0, 0, 0, 170 };
+static const SDL_Color OVERLAY_GRAPH_COLOR = { 255, 255, 255, 24 };
+static const SDL_Color OVERLAY_BUDGET_COLOR = { 255, 255, 255, 90 };
+static const SDL_Color OVERLAY_TEXT_COLOR = { 235, 235, 235, 255 };
+static const SDL_Color OVERLAY_LABEL_COLOR = { 150, 150, 150, 255 };
+static const SDL_Color OVERLAY_GOOD_COLOR = { 90, 220, 110, 255 };
+static const SDL_Color OVERLAY_SLOW_COLOR = { 240, 200, 60, 255 };
+static const SDL_Color OVERLAY_BAD_COLOR = { 240, 80, 70, 255 };
+
+static SDL_Texture* internal_overlay_bake_atlas(SDL_Renderer* renderer) {
+  // White everywhere so filtering never darkens edges; the font only sets alpha.
+  uint32_t pixels[OVERLAY_ATLAS_WIDTH * OVERLAY_ATLAS_HEIGHT];
+  for (int i = 0; i < OVERLAY_ATLAS_WIDTH * OVERLAY_ATLAS_HEIGHT; i++) pixels[i] = 0x00FFFFFFu;
+
+  for (int glyph = 0; glyph < OVERLAY_GLYPH_COUNT; glyph++) {
+    int cell_x = glyph % OVERLAY_ATLAS_COLUMNS * OVERLAY_ATLAS_CELL;
+    int cell_y = glyph / OVERLAY_ATLAS_COLUMNS * OVERLAY_ATLAS_CELL;
+    for (int row = 0; row < OVERLAY_GLYPH_HEIGHT; row++) {
+      for (int column = 0; column < OVERLAY_GLYPH_WIDTH; column++) {
+        if ((OVERLAY_FONT[glyph][row] >> (OVERLAY_GLYPH_WIDTH - 1 - column)) & 1) {
+          pixels[(cell_y + row) * OVERLAY_ATLAS_WIDTH + cell_x + column] = 0xFFFFFFFFu;
+        }
+      }
+    }
+  }
+
+  SDL_Texture* atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+    OVERLAY_ATLAS_WIDTH, OVERLAY_ATLAS_HEIGHT);
+  if (!atlas) {
+    LOGGER_ERROR("SDL_CreateTexture Error: %s\n", SDL_GetError());
+    return NULL;
+  }
+
+  if (SDL_UpdateTexture(atlas, NULL, pixels, OVERLAY_ATLAS_WIDTH * (int)sizeof(uint32_t)) != 0) {
+    LOGGER_ERROR("SDL_UpdateTexture Error: %s\n", SDL_GetError());
+    SDL_DestroyTexture(atlas);
+    return NULL;
+  }
+  SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+  SDL_SetTextureScaleMode(atlas, SDL_ScaleModeNearest);
+  return atlas;
+}
+
+Overlay* Overlay_Create(SDL_Renderer* renderer) {
+  if (!renderer) return NULL;
+
+  Overlay* overlay = calloc(1, sizeof(Overlay));
+  if (!overlay) return NULL;
+
+  overlay->renderer = renderer;
+  overlay->shapes = malloc(OVERLAY_MAX_SHAPES * 4 * sizeof(SDL_Vertex));
+  overlay->glyphs = malloc(OVERLAY_MAX_GLYPHS * 4 * sizeof(SDL_Vertex));
+  overlay->indices = malloc(OVERLAY_MAX_QUADS * 6 * sizeof(int));
+  if (!overlay->shapes || !overlay->glyphs || !overlay->indices) {
+    LOGGER_ERROR("Failed to allocate overlay buffers\n");
+    Overlay_Destroy(overlay);
+    return NULL;
+  }
+
+  overlay->atlas = internal_overlay_bake_atlas(renderer);
+  if (!overlay->atlas) {
+    Overlay_Destroy(overlay);
+    return NULL;
+  }
+
+  for (int q = 0; q < OVERLAY_MAX_QUADS; q++) {
+    int* index = &overlay->indices[q * 6];
+    index[0] = q * 4 + 0;
+    index[1] = q * 4 + 1;
+    index[2] = q * 4 + 2;
+    index[3] = q * 4 + 0;
+    index[4] = q * 4 + 2;
+    index[5] = q * 4 + 3;
+  }
+
+  overlay->zone = Profiler_RegisterZone("overlay");
+  overlay->log_queue_metric = Metrics_RegisterGauge("logger_queue_depth");
+  return overlay;
+}
+
+void Overlay_Destroy(Overlay* overlay) {
+  if (!overlay) return;
+
+  if (overlay->atlas) SDL_DestroyTexture(overlay->atlas);
+  free(overlay->shapes);
+  free(overlay->glyphs);
+  free(overlay->indices);
+  free(overlay);
+}
+
+void Overlay_SetVisible(Overlay* overlay, bool visible) {
+  if (overlay) overlay->visible = visible;
+}
+
+void Overlay_Toggle(Overlay* overlay) {
+  if (overlay) overlay->visible = !overlay->visible;
+}
+
+bool Overlay_IsVisible(const Overlay* overlay) {
+  return overlay && overlay->visible;
+}
+
+void Overlay_OnDeviceReset(Overlay* overlay) {
+  if (!overlay) return;
+
+  // The old handle is dead but still owns its SDL bookkeeping.
+  if (overlay->atlas) SDL_DestroyTexture(overlay->atlas);
+  overlay->atlas = internal_overlay_bake_atlas(overlay->renderer);
+  if (!overlay->atlas) LOGGER_WARN("Overlay text unavailable until the next device reset\n");
+}
+
+void Overlay_RecordFrame(Overlay* overlay, double frame_ms, int draw_calls) {
+  if (!overlay) return;
+
+  overlay->frame_ms[overlay->frame_next] = (float)frame_ms;
+  overlay->frame_next = (overlay->frame_next + 1) % OVERLAY_HISTORY;
+  if (overlay->frame_count < OVERLAY_HISTORY) overlay->frame_count++;
+  overlay->draw_calls = draw_calls;
+}
+
+/* ---- Geometry ---- */
+
+static void internal_overlay_quad(SDL_Vertex* v, float x0, float y0, float x1, float y1, SDL_Color color,
+  float u0, float v0, float u1, float v1) {
+  v[0] = (SDL_Vertex){ { x0, y0 }, color, { u0, v0 } };
+  v[1] = (SDL_Vertex){ { x1, y0 }, color, { u1, v0 } };
+  v[2] = (SDL_Vertex){ { x1, y1 }, color, { u1, v1 } };
+  v[3] = (SDL_Vertex){ { x0, y1 }, color, { u0, v1 } };
+}
+
+static void internal_overlay_rect(Overlay* overlay, float x, float y, float width, float height, SDL_Color color) {
+  if (overlay->shape_count >= OVERLAY_MAX_SHAPES) return;
+
+  internal_overlay_quad(&overlay->shapes[overlay->shape_count * 4], x, y, x + width, y + height, color,
+    0.0f, 0.0f, 0.0f, 0.0f);
+  overlay->shape_count++;
+}
+
+// Appends one line of text and returns the y of the next line.
+static float internal_overlay_text(Overlay* overlay, float x, float y, SDL_Color color, const char* format, ...) {
+  char line[OVERLAY_LINE_SIZE];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+
+  for (const char* c = line; *c; c++, x += OVERLAY_ADVANCE) {
+    int code = (unsigned char)*c;
+    if (code >= 'a' && code <= 'z') code -= 'a' - 'A';
+    if (code <= OVERLAY_FIRST_GLYPH || code >= OVERLAY_FIRST_GLYPH + OVERLAY_GLYPH_COUNT) continue;
+    if (overlay->glyph_count >= OVERLAY_MAX_GLYPHS) break;
+
+    int glyph = code - OVERLAY_FIRST_GLYPH;
+    float u0 = (float)(glyph % OVERLAY_ATLAS_COLUMNS * OVERLAY_ATLAS_CELL) / OVERLAY_ATLAS_WIDTH;
+    float v0 = (float)(glyph / OVERLAY_ATLAS_COLUMNS * OVERLAY_ATLAS_CELL) / OVERLAY_ATLAS_HEIGHT;
+    float u1 = u0 + (float)OVERLAY_GLYPH_WIDTH / OVERLAY_ATLAS_WIDTH;
+    float v1 = v0 + (float)OVERLAY_GLYPH_HEIGHT / OVERLAY_ATLAS_HEIGHT;
+
+    internal_overlay_quad(&overlay->glyphs[overlay->glyph_count * 4], x, y,
+      x + OVERLAY_GLYPH_WIDTH * OVERLAY_SCALE, y + OVERLAY_GLYPH_HEIGHT * OVERLAY_SCALE, color, u0, v0, u1, v1);
+    overlay->glyph_count++;
+  }
+
+  return y + OVERLAY_LINE_HEIGHT;
+}
+
+static SDL_Color internal_overlay_frame_color(double ms) {
+  if (ms <= 1000.0 / 60.0) return OVERLAY_GOOD_COLOR;
+  if (ms <= 1000.0 / 30.0) return OVERLAY_SLOW_COLOR;
+  return OVERLAY_BAD_COLOR;
+}
+
+// Oldest frame on the left, with lines at the 60 and 30 FPS budgets.
+static void internal_overlay_graph(Overlay* overlay, float x, float y) {
+  internal_overlay_rect(overlay, x, y, OVERLAY_GRAPH_WIDTH, OVERLAY_GRAPH_HEIGHT, OVERLAY_GRAPH_COLOR);
+
+  float bar_width = OVERLAY_GRAPH_WIDTH / OVERLAY_HISTORY;
+  float bottom = y + OVERLAY_GRAPH_HEIGHT;
+  for (int i = 0; i < overlay->frame_count; i++) {
+    int index = (overlay->frame_next - overlay->frame_count + i + OVERLAY_HISTORY) % OVERLAY_HISTORY;
+    double ms = overlay->frame_ms[index];
+    double fraction = ms < OVERLAY_GRAPH_MAX_MS ? ms / OVERLAY_GRAPH_MAX_MS : 1.0;
+    float height = (float)fraction * OVERLAY_GRAPH_HEIGHT;
+    if (height < 1.0f) height = 1.0f;
+
+    float bar_x = x + OVERLAY_GRAPH_WIDTH - (float)(overlay->frame_count - i) * bar_width;
+    internal_overlay_rect(overlay, bar_x, bottom - height, bar_width, height, internal_overlay_frame_color(ms));
+  }
+
+  static const double budgets_ms[] = { 1000.0 / 60.0, 1000.0 / 30.0 };
+  for (int b = 0; b < 2; b++) {
+    float line_y = bottom - (float)(budgets_ms[b] / OVERLAY_GRAPH_MAX_MS) * OVERLAY_GRAPH_HEIGHT;
+    internal_overlay_rect(overlay, x, line_y, OVERLAY_GRAPH_WIDTH, 1.0f, OVERLAY_BUDGET_COLOR);
+  }
+}
+
+static void internal_overlay_build(Overlay* overlay) {
+  overlay->shape_count = 1; // The panel goes first, sized once the content is known
+  overlay->glyph_count = 0;
+
+  double last_ms = 0.0;
+  double total_ms = 0.0;
+  double max_ms = 0.0;
+  for (int i = 0; i < overlay->frame_count; i++) {
+    double ms = overlay->frame_ms[i];
+    total_ms += ms;
+    if (ms > max_ms) max_ms = ms;
+  }
+  double average_ms = overlay->frame_count ? total_ms / overlay->frame_count : 0.0;
+  if (overlay->frame_count) last_ms = overlay->frame_ms[(overlay->frame_next + OVERLAY_HISTORY - 1) % OVERLAY_HISTORY];
+
+  float x = OVERLAY_MARGIN + OVERLAY_PADDING;
+  float y = OVERLAY_MARGIN + OVERLAY_PADDING;
+
+  y = internal_overlay_text(overlay, x, y, internal_overlay_frame_color(last_ms), "FRAME %6.2f MS %6.1f FPS",
+    last_ms, average_ms > 0.0 ? 1000.0 / average_ms : 0.0);
+  y = internal_overlay_text(overlay, x, y, OVERLAY_TEXT_COLOR, "AVG   %6.2f MS MAX %6.2f", average_ms, max_ms);
+
+  internal_overlay_graph(overlay, x, y);
+  y += OVERLAY_GRAPH_HEIGHT + OVERLAY_PADDING;
+
+  y = internal_overlay_text(overlay, x, y, OVERLAY_TEXT_COLOR, "DRAWS %-5d LOG QUEUE %lld",
+    overlay->draw_calls, (long long)Metrics_GaugeRead(overlay->log_queue_metric));
+  y = internal_overlay_text(overlay, x, y, OVERLAY_TEXT_COLOR, "MEMORY %.2f MB",
+    (double)Metrics_SumGauges("memory_") / (1024.0 * 1024.0));
+
+  Profiler_ZoneStats zones[OVERLAY_TOP_ZONES];
+  int zone_count = Profiler_GetTopZones(zones, OVERLAY_TOP_ZONES);
+  y = internal_overlay_text(overlay, x, y, OVERLAY_LABEL_COLOR, "%-12s %7s %7s", "ZONE MS", "LAST", "AVG");
+  for (int z = 0; z < zone_count; z++) {
+    y = internal_overlay_text(overlay, x, y, OVERLAY_TEXT_COLOR, "%-12.12s %7.2f %7.2f",
+      zones[z].name, zones[z].last_ms, zones[z].average_ms);
+  }
+
+  internal_overlay_quad(&overlay->shapes[0], OVERLAY_MARGIN, OVERLAY_MARGIN,
+    OVERLAY_MARGIN + OVERLAY_GRAPH_WIDTH + 2 * OVERLAY_PADDING, y + OVERLAY_PADDING, OVERLAY_PANEL_COLOR,
+    0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+int Overlay_Draw(Overlay* overlay) {
+  if (!overlay || !overlay->visible) return 0;
+
+  uint64_t start = Profiler_Begin();
+  internal_overlay_build(overlay);
+
+  // Untextured geometry blends with the renderer's draw blend mode.
+  SDL_BlendMode previous = SDL_BLENDMODE_NONE;
+  SDL_GetRenderDrawBlendMode(overlay->renderer, &previous);
+  SDL_SetRenderDrawBlendMode(overlay->renderer, SDL_BLENDMODE_BLEND);
+
+  int draw_calls = 0;
+  if (SDL_RenderGeometry(overlay->renderer, NULL, overlay->shapes, overlay->shape_count * 4,
+      overlay->indices, overlay->shape_count * 6) != 0) {
+    LOGGER_ERROR("SDL_RenderGeometry Error: %s\n", SDL_GetError());
+  } else {
+    draw_calls++;
+  }
+
+  if (overlay->glyph_count > 0 && overlay->atlas) {
+    if (SDL_RenderGeometry(overlay->renderer, overlay->atlas, overlay->glyphs, overlay->glyph_count * 4,
+        overlay->indices, overlay->glyph_count * 6) != 0) {
+      LOGGER_ERROR("SDL_RenderGeometry Error: %s\n", SDL_GetError());
+    } else {
+      draw_calls++;
+    }
+  }
+
+  SDL_SetRenderDrawBlendMode(overlay->renderer, previous);
+  Profiler_End(overlay->zone, start);
+  return draw_calls;
+}
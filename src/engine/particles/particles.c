@@ -0,0 +1,523 @@
+#include <engine/particles/particles.h>
+#include <engine/jobs/jobs.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PARTICLES_HAS_X86 1
+#else
+#define PARTICLES_HAS_X86 0
+#endif
+
+#define PARTICLES_ALIGNMENT 32
+#define PARTICLES_LANES 8
+#define PARTICLES_PARALLEL_THRESHOLD 16384
+#define PARTICLES_PARALLEL_BLOCK 4096
+
+typedef enum {
+  PARTICLES_KERNEL_SCALAR,
+  PARTICLES_KERNEL_SSE2,
+  PARTICLES_KERNEL_AVX2
+} Particles_Kernel;
+
+// Every array holds capacity entries and is 32-byte aligned. capacity is a
+// multiple of PARTICLES_LANES, so SIMD passes may run past count safely.
+typedef struct {
+  float* x;
+  float* y;
+  float* vx;
+  float* vy;
+  float* life;
+  float* inv_life_total;
+  uint32_t* color; // SDL_Color bytes (r, g, b, a) in memory order
+} Particle_Arrays;
+
+struct Particle_System {
+  Particle_Arrays a;
+  void* block;
+  int count;
+  int capacity;
+
+  float gx, gy;
+  float size;
+  SDL_Texture* texture;
+  bool parallel;
+
+  uint32_t rng[PARTICLES_LANES];
+
+  SDL_Vertex* vertices;
+  int* indices;
+
+  size_t memory_bytes;
+  Metrics_Gauge* memory_metric;
+};
+
+typedef struct {
+  void (*emit)(Particle_System* system, const Particle_Emitter* emitter, int begin, int end);
+  void (*update)(Particle_Arrays* a, int begin, int end, float dt, float gx, float gy);
+  unsigned (*alive_mask)(const float* life); // One bit per lane of an 8-particle block
+} Particles_Kernels;
+
+static Particles_Kernel g_kernel = PARTICLES_KERNEL_SCALAR;
+static bool g_kernel_detected = false;
+
+
+/* ---- Scalar kernels ---- */
+
+static inline uint32_t particles_xorshift(uint32_t* state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+// Uniform float in [-1, 1) built straight from the mantissa bits.
+static inline float particles_random_signed(uint32_t* state) {
+  union { uint32_t u; float f; } bits = { (particles_xorshift(state) >> 9) | 0x3F800000u };
+  return (bits.f - 1.0f) * 2.0f - 1.0f;
+}
+
+static inline uint32_t particles_pack_color(SDL_Color color) {
+  return (uint32_t)color.r | ((uint32_t)color.g << 8) | ((uint32_t)color.b << 16) | ((uint32_t)color.a << 24);
+}
+
+static void particles_emit_scalar(Particle_System* system, const Particle_Emitter* e, int begin, int end) {
+  Particle_Arrays* a = &system->a;
+  float life_mid = (e->life_min + e->life_max) * 0.5f;
+  float life_half = (e->life_max - e->life_min) * 0.5f;
+  uint32_t color = particles_pack_color(e->color);
+
+  for (int i = begin; i < end; i++) {
+    a->x[i] = e->x + particles_random_signed(&system->rng[0]) * e->position_jitter;
+    a->y[i] = e->y + particles_random_signed(&system->rng[0]) * e->position_jitter;
+    a->vx[i] = e->vx + particles_random_signed(&system->rng[0]) * e->velocity_jitter;
+    a->vy[i] = e->vy + particles_random_signed(&system->rng[0]) * e->velocity_jitter;
+    a->life[i] = life_mid + particles_random_signed(&system->rng[0]) * life_half;
+    a->inv_life_total[i] = 1.0f / a->life[i];
+    a->color[i] = color;
+  }
+}
+
+static void particles_update_scalar(Particle_Arrays* a, int begin, int end, float dt, float gx, float gy) {
+  for (int i = begin; i < end; i++) {
+    a->x[i] += a->vx[i] * dt;
+    a->y[i] += a->vy[i] * dt;
+    a->vx[i] += gx * dt;
+    a->vy[i] += gy * dt;
+    a->life[i] -= dt;
+  }
+}
+
+static unsigned particles_alive_mask_scalar(const float* life) {
+  unsigned mask = 0;
+  for (int lane = 0; lane < PARTICLES_LANES; lane++) {
+    if (life[lane] > 0.0f) mask |= 1u << lane;
+  }
+  return mask;
+}
+
+
+/* ---- SSE2 / AVX2 kernels ----
+ * The emitter keeps one xorshift32 state per lane in rng[], so random
+ * numbers for 4 or 8 particles come out of a handful of shifts and xors. */
+
+#if PARTICLES_HAS_X86
+
+__attribute__((target("sse2")))
+static inline __m128 particles_random_signed_sse2(__m128i* state) {
+  __m128i x = *state;
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+  *state = x;
+
+  __m128 f = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x3F800000)));
+  return _mm_sub_ps(_mm_mul_ps(f, _mm_set1_ps(2.0f)), _mm_set1_ps(3.0f));
+}
+
+__attribute__((target("sse2")))
+static void particles_emit_sse2(Particle_System* system, const Particle_Emitter* e, int begin, int end) {
+  Particle_Arrays* a = &system->a;
+  __m128i state = _mm_loadu_si128((const __m128i*)system->rng);
+  const __m128 x = _mm_set1_ps(e->x), y = _mm_set1_ps(e->y);
+  const __m128 vx = _mm_set1_ps(e->vx), vy = _mm_set1_ps(e->vy);
+  const __m128 pj = _mm_set1_ps(e->position_jitter), vj = _mm_set1_ps(e->velocity_jitter);
+  const __m128 life_mid = _mm_set1_ps((e->life_min + e->life_max) * 0.5f);
+  const __m128 life_half = _mm_set1_ps((e->life_max - e->life_min) * 0.5f);
+  const __m128i color = _mm_set1_epi32((int)particles_pack_color(e->color));
+  int i = begin;
+
+  for (; i + 4 <= end; i += 4) {
+    _mm_storeu_ps(a->x + i, _mm_add_ps(x, _mm_mul_ps(particles_random_signed_sse2(&state), pj)));
+    _mm_storeu_ps(a->y + i, _mm_add_ps(y, _mm_mul_ps(particles_random_signed_sse2(&state), pj)));
+    _mm_storeu_ps(a->vx + i, _mm_add_ps(vx, _mm_mul_ps(particles_random_signed_sse2(&state), vj)));
+    _mm_storeu_ps(a->vy + i, _mm_add_ps(vy, _mm_mul_ps(particles_random_signed_sse2(&state), vj)));
+    __m128 life = _mm_add_ps(life_mid, _mm_mul_ps(particles_random_signed_sse2(&state), life_half));
+    _mm_storeu_ps(a->life + i, life);
+    _mm_storeu_ps(a->inv_life_total + i, _mm_div_ps(_mm_set1_ps(1.0f), life));
+    _mm_storeu_si128((__m128i*)(a->color + i), color);
+  }
+
+  _mm_storeu_si128((__m128i*)system->rng, state);
+  particles_emit_scalar(system, e, i, end);
+}
+
+__attribute__((target("sse2")))
+static void particles_update_sse2(Particle_Arrays* a, int begin, int end, float dt, float gx, float gy) {
+  const __m128 vdt = _mm_set1_ps(dt);
+  const __m128 gx_dt = _mm_set1_ps(gx * dt), gy_dt = _mm_set1_ps(gy * dt);
+
+  for (int i = begin; i < end; i += 4) {
+    __m128 vx = _mm_load_ps(a->vx + i);
+    __m128 vy = _mm_load_ps(a->vy + i);
+    _mm_store_ps(a->x + i, _mm_add_ps(_mm_load_ps(a->x + i), _mm_mul_ps(vx, vdt)));
+    _mm_store_ps(a->y + i, _mm_add_ps(_mm_load_ps(a->y + i), _mm_mul_ps(vy, vdt)));
+    _mm_store_ps(a->vx + i, _mm_add_ps(vx, gx_dt));
+    _mm_store_ps(a->vy + i, _mm_add_ps(vy, gy_dt));
+    _mm_store_ps(a->life + i, _mm_sub_ps(_mm_load_ps(a->life + i), vdt));
+  }
+}
+
+__attribute__((target("sse2")))
+static unsigned particles_alive_mask_sse2(const float* life) {
+  const __m128 zero = _mm_setzero_ps();
+  unsigned lo = (unsigned)_mm_movemask_ps(_mm_cmpgt_ps(_mm_load_ps(life), zero));
+  unsigned hi = (unsigned)_mm_movemask_ps(_mm_cmpgt_ps(_mm_load_ps(life + 4), zero));
+  return lo | (hi << 4);
+}
+
+__attribute__((target("avx2")))
+static inline __m256 particles_random_signed_avx2(__m256i* state) {
+  __m256i x = *state;
+  x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+  x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+  *state = x;
+
+  __m256 f = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(x, 9), _mm256_set1_epi32(0x3F800000)));
+  return _mm256_sub_ps(_mm256_mul_ps(f, _mm256_set1_ps(2.0f)), _mm256_set1_ps(3.0f));
+}
+
+__attribute__((target("avx2")))
+static void particles_emit_avx2(Particle_System* system, const Particle_Emitter* e, int begin, int end) {
+  Particle_Arrays* a = &system->a;
+  __m256i state = _mm256_loadu_si256((const __m256i*)system->rng);
+  const __m256 x = _mm256_set1_ps(e->x), y = _mm256_set1_ps(e->y);
+  const __m256 vx = _mm256_set1_ps(e->vx), vy = _mm256_set1_ps(e->vy);
+  const __m256 pj = _mm256_set1_ps(e->position_jitter), vj = _mm256_set1_ps(e->velocity_jitter);
+  const __m256 life_mid = _mm256_set1_ps((e->life_min + e->life_max) * 0.5f);
+  const __m256 life_half = _mm256_set1_ps((e->life_max - e->life_min) * 0.5f);
+  const __m256i color = _mm256_set1_epi32((int)particles_pack_color(e->color));
+  int i = begin;
+
+  for (; i + 8 <= end; i += 8) {
+    _mm256_storeu_ps(a->x + i, _mm256_add_ps(x, _mm256_mul_ps(particles_random_signed_avx2(&state), pj)));
+    _mm256_storeu_ps(a->y + i, _mm256_add_ps(y, _mm256_mul_ps(particles_random_signed_avx2(&state), pj)));
+    _mm256_storeu_ps(a->vx + i, _mm256_add_ps(vx, _mm256_mul_ps(particles_random_signed_avx2(&state), vj)));
+    _mm256_storeu_ps(a->vy + i, _mm256_add_ps(vy, _mm256_mul_ps(particles_random_signed_avx2(&state), vj)));
+    __m256 life = _mm256_add_ps(life_mid, _mm256_mul_ps(particles_random_signed_avx2(&state), life_half));
+    _mm256_storeu_ps(a->life + i, life);
+    _mm256_storeu_ps(a->inv_life_total + i, _mm256_div_ps(_mm256_set1_ps(1.0f), life));
+    _mm256_storeu_si256((__m256i*)(a->color + i), color);
+  }
+
+  _mm256_storeu_si256((__m256i*)system->rng, state);
+  particles_emit_scalar(system, e, i, end);
+}
+
+__attribute__((target("avx2")))
+static void particles_update_avx2(Particle_Arrays* a, int begin, int end, float dt, float gx, float gy) {
+  const __m256 vdt = _mm256_set1_ps(dt);
+  const __m256 gx_dt = _mm256_set1_ps(gx * dt), gy_dt = _mm256_set1_ps(gy * dt);
+
+  for (int i = begin; i < end; i += 8) {
+    __m256 vx = _mm256_load_ps(a->vx + i);
+    __m256 vy = _mm256_load_ps(a->vy + i);
+    _mm256_store_ps(a->x + i, _mm256_add_ps(_mm256_load_ps(a->x + i), _mm256_mul_ps(vx, vdt)));
+    _mm256_store_ps(a->y + i, _mm256_add_ps(_mm256_load_ps(a->y + i), _mm256_mul_ps(vy, vdt)));
+    _mm256_store_ps(a->vx + i, _mm256_add_ps(vx, gx_dt));
+    _mm256_store_ps(a->vy + i, _mm256_add_ps(vy, gy_dt));
+    _mm256_store_ps(a->life + i, _mm256_sub_ps(_mm256_load_ps(a->life + i), vdt));
+  }
+}
+
+__attribute__((target("avx2")))
+static unsigned particles_alive_mask_avx2(const float* life) {
+  return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_load_ps(life), _mm256_setzero_ps(), _CMP_GT_OQ));
+}
+
+#endif
+
+
+/* ---- Kernel selection ---- */
+
+static Particles_Kernel internal_particles_kernel(void) {
+  if (!g_kernel_detected) {
+#if PARTICLES_HAS_X86
+    if (SDL_HasAVX2()) {
+      g_kernel = PARTICLES_KERNEL_AVX2;
+    } else if (SDL_HasSSE2()) {
+      g_kernel = PARTICLES_KERNEL_SSE2;
+    }
+#endif
+    g_kernel_detected = true;
+  }
+
+  return g_kernel;
+}
+
+static Particles_Kernels internal_particles_kernels(void) {
+  switch (internal_particles_kernel()) {
+#if PARTICLES_HAS_X86
+    case PARTICLES_KERNEL_AVX2:
+      return (Particles_Kernels){ particles_emit_avx2, particles_update_avx2, particles_alive_mask_avx2 };
+    case PARTICLES_KERNEL_SSE2:
+      return (Particles_Kernels){ particles_emit_sse2, particles_update_sse2, particles_alive_mask_sse2 };
+#endif
+    default:
+      return (Particles_Kernels){ particles_emit_scalar, particles_update_scalar, particles_alive_mask_scalar };
+  }
+}
+
+
+/* ---- Particle system ---- */
+
+Particle_System* Particles_Create(int capacity, SDL_Texture* texture, float size) {
+  if (capacity <= 0) return NULL;
+
+  Particle_System* system = calloc(1, sizeof(Particle_System));
+  if (!system) return NULL;
+
+  capacity = (capacity + PARTICLES_LANES - 1) / PARTICLES_LANES * PARTICLES_LANES;
+  size_t array_bytes = (size_t)capacity * sizeof(float);
+
+  system->block = aligned_alloc(PARTICLES_ALIGNMENT, array_bytes * 7);
+  system->vertices = malloc((size_t)capacity * 4 * sizeof(SDL_Vertex));
+  system->indices = malloc((size_t)capacity * 6 * sizeof(int));
+  if (!system->block || !system->vertices || !system->indices) {
+    LOGGER_ERROR("Failed to allocate particle system of %d particles\n", capacity);
+    Particles_Destroy(system);
+    return NULL;
+  }
+
+  char* base = system->block;
+  system->a.x = (float*)(base + array_bytes * 0);
+  system->a.y = (float*)(base + array_bytes * 1);
+  system->a.vx = (float*)(base + array_bytes * 2);
+  system->a.vy = (float*)(base + array_bytes * 3);
+  system->a.life = (float*)(base + array_bytes * 4);
+  system->a.inv_life_total = (float*)(base + array_bytes * 5);
+  system->a.color = (uint32_t*)(base + array_bytes * 6);
+  memset(system->block, 0, array_bytes * 7);
+
+  // The quad index pattern never changes, so it is built once.
+  for (int p = 0; p < capacity; p++) {
+    int* index = &system->indices[p * 6];
+    index[0] = p * 4 + 0;
+    index[1] = p * 4 + 1;
+    index[2] = p * 4 + 2;
+    index[3] = p * 4 + 0;
+    index[4] = p * 4 + 2;
+    index[5] = p * 4 + 3;
+  }
+
+  for (int lane = 0; lane < PARTICLES_LANES; lane++) {
+    system->rng[lane] = 0x9E3779B9u * (uint32_t)(lane + 1);
+  }
+
+  system->memory_bytes = array_bytes * 7 + (size_t)capacity * (4 * sizeof(SDL_Vertex) + 6 * sizeof(int));
+  system->memory_metric = Metrics_RegisterGauge("memory_particles_bytes");
+  Metrics_GaugeAdd(system->memory_metric, (int64_t)system->memory_bytes);
+
+  system->capacity = capacity;
+  system->texture = texture;
+  system->size = size;
+  system->parallel = true;
+
+  return system;
+}
+
+void Particles_Destroy(Particle_System* system) {
+  if (!system) return;
+
+  Metrics_GaugeAdd(system->memory_metric, -(int64_t)system->memory_bytes);
+  free(system->block);
+  free(system->vertices);
+  free(system->indices);
+  free(system);
+}
+
+void Particles_SetGravity(Particle_System* system, float gx, float gy) {
+  if (!system) return;
+
+  system->gx = gx;
+  system->gy = gy;
+}
+
+void Particles_SetParallel(Particle_System* system, bool parallel) {
+  if (system) system->parallel = parallel;
+}
+
+int Particles_GetCount(const Particle_System* system) {
+  return system ? system->count : 0;
+}
+
+int Particles_Emit(Particle_System* system, const Particle_Emitter* emitter, int count) {
+  if (!system || !emitter || count <= 0) return 0;
+
+  if (count > system->capacity - system->count) count = system->capacity - system->count;
+  if (count == 0) return 0;
+
+  internal_particles_kernels().emit(system, emitter, system->count, system->count + count);
+  system->count += count;
+
+  return count;
+}
+
+typedef struct {
+  Particle_System* system;
+  Particles_Kernels kernels;
+  float dt;
+} Particles_UpdateJob;
+
+static void internal_particles_update_blocks(int begin, int end, void* data) {
+  Particles_UpdateJob* job = data;
+  Particle_System* system = job->system;
+
+  int first = begin * PARTICLES_PARALLEL_BLOCK;
+  int last = end * PARTICLES_PARALLEL_BLOCK;
+  if (last > system->count) last = system->count;
+
+  job->kernels.update(&system->a, first, last, job->dt, system->gx, system->gy);
+}
+
+static inline void internal_particles_move(Particle_Arrays* a, int from, int to) {
+  a->x[to] = a->x[from];
+  a->y[to] = a->y[from];
+  a->vx[to] = a->vx[from];
+  a->vy[to] = a->vy[from];
+  a->life[to] = a->life[from];
+  a->inv_life_total[to] = a->inv_life_total[from];
+  a->color[to] = a->color[from];
+}
+
+// Order-preserving compaction. Blocks that are fully alive and not yet
+// shifted are skipped with a single mask test.
+static void internal_particles_compact(Particle_System* system, const Particles_Kernels* kernels) {
+  Particle_Arrays* a = &system->a;
+  int count = system->count;
+  int write = 0;
+
+  for (int i = 0; i < count; i += PARTICLES_LANES) {
+    int lanes = count - i < PARTICLES_LANES ? count - i : PARTICLES_LANES;
+    unsigned full = (1u << lanes) - 1;
+    unsigned mask = kernels->alive_mask(a->life + i) & full;
+
+    if (mask == full && write == i) {
+      write += lanes;
+      continue;
+    }
+
+    while (mask) {
+      int lane = __builtin_ctz(mask);
+      internal_particles_move(a, i + lane, write++);
+      mask &= mask - 1;
+    }
+  }
+
+  system->count = write;
+}
+
+void Particles_Update(Particle_System* system, float dt) {
+  if (!system || system->count == 0) return;
+
+  Particles_UpdateJob job = { system, internal_particles_kernels(), dt };
+  int blocks = (system->count + PARTICLES_PARALLEL_BLOCK - 1) / PARTICLES_PARALLEL_BLOCK;
+
+  if (system->parallel && system->count >= PARTICLES_PARALLEL_THRESHOLD) {
+    Jobs_ParallelFor(blocks, 1, internal_particles_update_blocks, &job);
+  } else {
+    internal_particles_update_blocks(0, blocks, &job);
+  }
+
+  internal_particles_compact(system, &job.kernels);
+}
+
+void Particles_Draw(Particle_System* system, SDL_Renderer* renderer) {
+  if (!system || !renderer || system->count == 0) return;
+
+  const Particle_Arrays* a = &system->a;
+  float half = system->size * 0.5f;
+
+  for (int i = 0; i < system->count; i++) {
+    float fade = a->life[i] * a->inv_life_total[i];
+    if (fade > 1.0f) fade = 1.0f;
+
+    uint32_t packed = a->color[i];
+    SDL_Color color = { (Uint8)packed, (Uint8)(packed >> 8), (Uint8)(packed >> 16), (Uint8)((packed >> 24) * fade) };
+
+    SDL_Vertex* v = &system->vertices[i * 4];
+    v[0] = (SDL_Vertex){ { a->x[i] - half, a->y[i] - half }, color, { 0.0f, 0.0f } };
+    v[1] = (SDL_Vertex){ { a->x[i] + half, a->y[i] - half }, color, { 1.0f, 0.0f } };
+    v[2] = (SDL_Vertex){ { a->x[i] + half, a->y[i] + half }, color, { 1.0f, 1.0f } };
+    v[3] = (SDL_Vertex){ { a->x[i] - half, a->y[i] + half }, color, { 0.0f, 1.0f } };
+  }
+
+  if (SDL_RenderGeometry(renderer, system->texture, system->vertices, system->count * 4, system->indices, system->count * 6) != 0) {
+    LOGGER_ERROR("SDL_RenderGeometry Error: %s\n", SDL_GetError());
+  }
+}
+
+
+/* ---- Benchmark ---- */
+
+#define PARTICLES_BENCH_COUNT 262144
+#define PARTICLES_BENCH_FRAMES 200
+
+static void internal_particles_bench_run(Particles_Kernel kernel, bool parallel) {
+  Particle_System* system = Particles_Create(PARTICLES_BENCH_COUNT, NULL, 2.0f);
+  if (!system) return;
+
+  Particles_Kernel detected = internal_particles_kernel();
+  g_kernel = kernel;
+
+  // Lifetimes long enough that nothing dies, so every frame updates the full set.
+  Particle_Emitter emitter = { 640.0f, 360.0f, 32.0f, 0.0f, -100.0f, 50.0f, 1.0e6f, 1.0e6f, { 255, 200, 80, 255 } };
+  Particles_SetGravity(system, 0.0f, 98.0f);
+  Particles_SetParallel(system, parallel);
+  Particles_Emit(system, &emitter, PARTICLES_BENCH_COUNT);
+
+  uint64_t start = SDL_GetPerformanceCounter();
+  for (int frame = 0; frame < PARTICLES_BENCH_FRAMES; frame++) {
+    Particles_Update(system, 1.0f / 60.0f);
+  }
+  double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+  static const char* const names[] = { "scalar", "SSE2", "AVX2" };
+  LOGGER_INFO("Particles %-6s %-8s: %10.0f particles/ms (%.3f ms/frame for %d)\n",
+    names[kernel], parallel ? "parallel" : "single",
+    (double)system->count * PARTICLES_BENCH_FRAMES / ms, ms / PARTICLES_BENCH_FRAMES, system->count);
+
+  g_kernel = detected;
+  Particles_Destroy(system);
+}
+
+void Particles_Benchmark(void) {
+  LOGGER_INFO("Particle benchmark: %d particles, %d frames, %d job workers\n",
+    PARTICLES_BENCH_COUNT, PARTICLES_BENCH_FRAMES, Jobs_GetWorkerCount());
+
+  Particles_Kernel detected = internal_particles_kernel();
+
+  internal_particles_bench_run(PARTICLES_KERNEL_SCALAR, false);
+  internal_particles_bench_run(detected, false);
+  internal_particles_bench_run(detected, true);
+}
@@ -0,0 +1,103 @@
+#include <engine/profiler/profiler.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <SDL2/SDL.h>
+
+#define PROFILER_SMOOTHING 0.1 // Weight of the newest frame in average_ms
+
+struct Profiler_Zone {
+  char name[PROFILER_NAME_SIZE];
+  atomic_uint_fast64_t ticks; // Running total of the open frame
+  atomic_uint_fast32_t calls;
+
+  // Game thread only.
+  double last_ms;
+  double average_ms;
+  uint32_t last_calls;
+};
+
+// Zones are only ever appended, and g_zone_count is published with release
+// ordering, the same scheme as the metrics registry.
+static Profiler_Zone g_zones[PROFILER_MAX_ZONES];
+static atomic_int g_zone_count = 0;
+static pthread_mutex_t g_zones_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+Profiler_Zone* Profiler_RegisterZone(const char* name) {
+  if (name == NULL || strlen(name) >= PROFILER_NAME_SIZE) {
+    fprintf(stderr, "PROFILER ERROR: Invalid zone name.\n");
+    return NULL;
+  }
+
+  pthread_mutex_lock(&g_zones_mutex);
+
+  int count = atomic_load_explicit(&g_zone_count, memory_order_relaxed);
+  for (int i = 0; i < count; i++) {
+    if (strcmp(g_zones[i].name, name) == 0) {
+      pthread_mutex_unlock(&g_zones_mutex);
+      return &g_zones[i];
+    }
+  }
+
+  if (count == PROFILER_MAX_ZONES) {
+    pthread_mutex_unlock(&g_zones_mutex);
+    fprintf(stderr, "PROFILER ERROR: Zone table full, dropping %s.\n", name);
+    return NULL;
+  }
+
+  Profiler_Zone* zone = &g_zones[count];
+  strcpy(zone->name, name);
+  atomic_store_explicit(&g_zone_count, count + 1, memory_order_release);
+
+  pthread_mutex_unlock(&g_zones_mutex);
+  return zone;
+}
+
+void Profiler_End(Profiler_Zone* zone, uint64_t start) {
+  if (!zone) return;
+
+  uint64_t elapsed = SDL_GetPerformanceCounter() - start;
+  atomic_fetch_add_explicit(&zone->ticks, elapsed, memory_order_relaxed);
+  atomic_fetch_add_explicit(&zone->calls, 1, memory_order_relaxed);
+}
+
+void Profiler_EndFrame(void) {
+  int count = atomic_load_explicit(&g_zone_count, memory_order_acquire);
+  double ms_per_tick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+  for (int i = 0; i < count; i++) {
+    Profiler_Zone* zone = &g_zones[i];
+    uint64_t ticks = atomic_exchange_explicit(&zone->ticks, 0, memory_order_relaxed);
+
+    zone->last_ms = (double)ticks * ms_per_tick;
+    zone->last_calls = (uint32_t)atomic_exchange_explicit(&zone->calls, 0, memory_order_relaxed);
+    zone->average_ms += (zone->last_ms - zone->average_ms) * PROFILER_SMOOTHING;
+  }
+}
+
+int Profiler_GetTopZones(Profiler_ZoneStats* out, int max) {
+  if (!out || max <= 0) return 0;
+
+  int count = atomic_load_explicit(&g_zone_count, memory_order_acquire);
+  int found = 0;
+
+  // Insertion into a short sorted list; max is a handful of rows.
+  for (int i = 0; i < count; i++) {
+    const Profiler_Zone* zone = &g_zones[i];
+    int slot = found;
+    while (slot > 0 && out[slot - 1].average_ms < zone->average_ms) slot--;
+    if (slot >= max) continue;
+
+    int last = found < max ? found : max - 1;
+    memmove(&out[slot + 1], &out[slot], (size_t)(last - slot) * sizeof(Profiler_ZoneStats));
+    out[slot] = (Profiler_ZoneStats){ zone->name, zone->last_ms, zone->average_ms, zone->last_calls };
+    if (found < max) found++;
+  }
+
+  return found;
+}
@@ -0,0 +1,705 @@
+#include <engine/raster/raster.h>
+#include <engine/jobs/jobs.h>
+#include <engine/logger.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RASTER_HAS_X86 1
+#else
+#define RASTER_HAS_X86 0
+#endif
+
+#define RASTER_TILE_SIZE 64
+#define RASTER_GATHER_SIZE 256
+#define RASTER_TINT_NONE 0xFFFFFFFFu
+
+typedef enum {
+  RASTER_COMMAND_CLEAR,
+  RASTER_COMMAND_SPRITE
+} Raster_CommandType;
+
+typedef struct {
+  Raster_CommandType type;
+  SDL_BlendMode mode;
+  uint32_t color; // Clear color, or the sprite tint packed as ARGB8888
+  SDL_Surface* sprite;
+  SDL_Rect src;
+  SDL_Rect dst;
+  SDL_Rect bounds; // dst clipped to the framebuffer
+} Raster_Command;
+
+typedef struct {
+  int* commands;
+  int count;
+  int capacity;
+} Raster_Bin;
+
+struct Raster {
+  SDL_Surface* framebuffer;
+
+  Raster_Command* commands;
+  int command_count;
+  int command_capacity;
+
+  Raster_Bin* bins;
+  int tiles_x;
+  int tiles_y;
+
+  bool parallel;
+};
+
+// dst and src are ARGB8888 spans of count pixels; tint is ARGB8888 too.
+typedef void (*Raster_SpanFunction)(uint32_t* dst, const uint32_t* src, int count, uint32_t tint);
+
+typedef struct {
+  Raster_SpanFunction blend;
+  Raster_SpanFunction copy;
+} Raster_Kernels;
+
+static Raster_Kernel g_kernel = RASTER_KERNEL_SCALAR;
+static bool g_kernel_detected = false;
+
+
+/* ---- Scalar kernels ---- */
+
+// Exact round(a * b / 255) for a, b in [0, 255].
+static inline uint32_t raster_mul255(uint32_t a, uint32_t b) {
+  uint32_t x = a * b + 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t raster_tint_pixel(uint32_t pixel, uint32_t tint) {
+  return (raster_mul255(pixel >> 24, tint >> 24) << 24)
+       | (raster_mul255((pixel >> 16) & 0xFF, (tint >> 16) & 0xFF) << 16)
+       | (raster_mul255((pixel >> 8) & 0xFF, (tint >> 8) & 0xFF) << 8)
+       | raster_mul255(pixel & 0xFF, tint & 0xFF);
+}
+
+static inline uint32_t raster_blend_pixel(uint32_t dst, uint32_t src) {
+  uint32_t a = src >> 24;
+  uint32_t ia = 255 - a;
+
+  return ((a + raster_mul255(dst >> 24, ia)) << 24)
+       | ((raster_mul255((src >> 16) & 0xFF, a) + raster_mul255((dst >> 16) & 0xFF, ia)) << 16)
+       | ((raster_mul255((src >> 8) & 0xFF, a) + raster_mul255((dst >> 8) & 0xFF, ia)) << 8)
+       | (raster_mul255(src & 0xFF, a) + raster_mul255(dst & 0xFF, ia));
+}
+
+static void raster_blend_scalar(uint32_t* dst, const uint32_t* src, int count, uint32_t tint) {
+  if (tint == RASTER_TINT_NONE) {
+    for (int i = 0; i < count; i++) dst[i] = raster_blend_pixel(dst[i], src[i]);
+  } else {
+    for (int i = 0; i < count; i++) dst[i] = raster_blend_pixel(dst[i], raster_tint_pixel(src[i], tint));
+  }
+}
+
+static void raster_copy_scalar(uint32_t* dst, const uint32_t* src, int count, uint32_t tint) {
+  if (tint == RASTER_TINT_NONE) {
+    memcpy(dst, src, (size_t)count * sizeof(uint32_t));
+  } else {
+    for (int i = 0; i < count; i++) dst[i] = raster_tint_pixel(src[i], tint);
+  }
+}
+
+
+/* ---- SSE2 / AVX2 kernels ----
+ * Pixels are widened to 16-bit lanes (B, G, R, A per pixel) so the same
+ * rounded multiply as raster_mul255 can run on 4 (SSE2) or 8 (AVX2) pixels.
+ * The alpha lane of the source is forced to 255 before the blend multiply so
+ * the output alpha comes out as a + da * (255 - a). */
+
+#if RASTER_HAS_X86
+
+__attribute__((target("sse2")))
+static inline __m128i raster_mul255_sse2(__m128i a, __m128i b) {
+  __m128i x = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i raster_blend4_sse2(__m128i d, __m128i s, __m128i tint16, bool tinted) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_lane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  const __m128i full = _mm_set1_epi16(255);
+
+  __m128i s_lo = _mm_unpacklo_epi8(s, zero);
+  __m128i s_hi = _mm_unpackhi_epi8(s, zero);
+  if (tinted) {
+    s_lo = raster_mul255_sse2(s_lo, tint16);
+    s_hi = raster_mul255_sse2(s_hi, tint16);
+  }
+
+  __m128i a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo, 0xFF), 0xFF);
+  __m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi, 0xFF), 0xFF);
+
+  __m128i o_lo = _mm_add_epi16(
+    raster_mul255_sse2(_mm_or_si128(s_lo, alpha_lane), a_lo),
+    raster_mul255_sse2(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(full, a_lo)));
+  __m128i o_hi = _mm_add_epi16(
+    raster_mul255_sse2(_mm_or_si128(s_hi, alpha_lane), a_hi),
+    raster_mul255_sse2(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(full, a_hi)));
+
+  return _mm_packus_epi16(o_lo, o_hi);
+}
+
+__attribute__((target("sse2")))
+static void raster_blend_sse2(uint32_t* dst, const uint32_t* src, int count, uint32_t tint) {
+  bool tinted = tint != RASTER_TINT_NONE;
+  __m128i tint16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)tint), _mm_setzero_si128());
+  int i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+    _mm_storeu_si128((__m128i*)(dst + i), raster_blend4_sse2(d, s, tint16, tinted));
+  }
+
+  raster_blend_scalar(dst + i, src + i, count - i, tint);
+}
+
+__attribute__((target("sse2")))
+static void raster_copy_sse2(uint32_t* dst, const uint32_t* src, int count, uint32_t tint) {
+  if (tint == RASTER_TINT_NONE) {
+    memcpy(dst, src, (size_t)count * sizeof(uint32_t));
+    return;
+  }
+
+  const __m128i zero = _mm_setzero_si128();
+  __m128i tint16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)tint), zero);
+  int i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i lo = raster_mul255_sse2(_mm_unpacklo_epi8(s, zero), tint16);
+    __m128i hi = raster_mul255_sse2(_mm_unpackhi_epi8(s, zero), tint16);
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+  }
+
+  raster_copy_scalar(dst + i, src + i, count - i, tint);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i raster_mul255_avx2(__m256i a, __m256i b) {
+  __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+// Unpack and pack both work within 128-bit lanes, so pixel order round-trips.
+__attribute__((target("avx2")))
+static void raster_blend_avx2(uint32_t* dst, const uint32_t* src, int count, uint32_t tint) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i alpha_lane = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+  const __m256i full = _mm256_set1_epi16(255);
+  bool tinted = tint != RASTER_TINT_NONE;
+  __m256i tint16 = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)tint), zero);
+  int i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+
+    __m256i s_lo = _mm256_unpacklo_epi8(s, zero);
+    __m256i s_hi = _mm256_unpackhi_epi8(s, zero);
+    if (tinted) {
+      s_lo = raster_mul255_avx2(s_lo, tint16);
+      s_hi = raster_mul255_avx2(s_hi, tint16);
+    }
+
+    __m256i a_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_lo, 0xFF), 0xFF);
+    __m256i a_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_hi, 0xFF), 0xFF);
+
+    __m256i o_lo = _mm256_add_epi16(
+      raster_mul255_avx2(_mm256_or_si256(s_lo, alpha_lane), a_lo),
+      raster_mul255_avx2(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(full, a_lo)));
+    __m256i o_hi = _mm256_add_epi16(
+      raster_mul255_avx2(_mm256_or_si256(s_hi, alpha_lane), a_hi),
+      raster_mul255_avx2(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(full, a_hi)));
+
+    _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(o_lo, o_hi));
+  }
+
+  // The tail stays scalar: dropping into legacy-encoded SSE2 code from here
+  // pays an AVX/SSE state transition on every span.
+  raster_blend_scalar(dst + i, src + i, count - i, tint);
+}
+
+__attribute__((target("avx2")))
+static void raster_copy_avx2(uint32_t* dst, const uint32_t* src, int count, uint32_t tint) {
+  if (tint == RASTER_TINT_NONE) {
+    memcpy(dst, src, (size_t)count * sizeof(uint32_t));
+    return;
+  }
+
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i tint16 = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)tint), zero);
+  int i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i lo = raster_mul255_avx2(_mm256_unpacklo_epi8(s, zero), tint16);
+    __m256i hi = raster_mul255_avx2(_mm256_unpackhi_epi8(s, zero), tint16);
+    _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(lo, hi));
+  }
+
+  raster_copy_scalar(dst + i, src + i, count - i, tint);
+}
+
+#endif
+
+
+/* ---- Kernel selection ---- */
+
+static bool internal_raster_kernel_supported(Raster_Kernel kernel) {
+  switch (kernel) {
+    case RASTER_KERNEL_SCALAR:
+      return true;
+#if RASTER_HAS_X86
+    case RASTER_KERNEL_SSE2:
+      return SDL_HasSSE2();
+    case RASTER_KERNEL_AVX2:
+      return SDL_HasSSE2() && SDL_HasAVX2();
+#endif
+    default:
+      return false;
+  }
+}
+
+static Raster_Kernels internal_raster_kernels(void) {
+  switch (Raster_GetKernel()) {
+#if RASTER_HAS_X86
+    case RASTER_KERNEL_AVX2:
+      return (Raster_Kernels){ raster_blend_avx2, raster_copy_avx2 };
+    case RASTER_KERNEL_SSE2:
+      return (Raster_Kernels){ raster_blend_sse2, raster_copy_sse2 };
+#endif
+    default:
+      return (Raster_Kernels){ raster_blend_scalar, raster_copy_scalar };
+  }
+}
+
+Raster_Kernel Raster_GetKernel(void) {
+  if (!g_kernel_detected) {
+    if (internal_raster_kernel_supported(RASTER_KERNEL_AVX2)) {
+      g_kernel = RASTER_KERNEL_AVX2;
+    } else if (internal_raster_kernel_supported(RASTER_KERNEL_SSE2)) {
+      g_kernel = RASTER_KERNEL_SSE2;
+    } else {
+      g_kernel = RASTER_KERNEL_SCALAR;
+    }
+    g_kernel_detected = true;
+    LOGGER_INFO("Raster kernel: %s\n", Raster_KernelName(g_kernel));
+  }
+
+  return g_kernel;
+}
+
+bool Raster_ForceKernel(Raster_Kernel kernel) {
+  if (!internal_raster_kernel_supported(kernel)) return false;
+
+  g_kernel = kernel;
+  g_kernel_detected = true;
+  return true;
+}
+
+const char* Raster_KernelName(Raster_Kernel kernel) {
+  switch (kernel) {
+    case RASTER_KERNEL_SCALAR:
+      return "scalar";
+    case RASTER_KERNEL_SSE2:
+      return "SSE2";
+    case RASTER_KERNEL_AVX2:
+      return "AVX2";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+
+/* ---- Raster ---- */
+
+static bool internal_raster_is_argb(const SDL_Surface* surface) {
+  return surface != NULL && surface->format->format == SDL_PIXELFORMAT_ARGB8888;
+}
+
+Raster* Raster_Create(SDL_Surface* framebuffer) {
+  if (!internal_raster_is_argb(framebuffer)) {
+    LOGGER_ERROR("Raster_Create requires an ARGB8888 framebuffer\n");
+    return NULL;
+  }
+
+  Raster* raster = calloc(1, sizeof(Raster));
+  if (!raster) return NULL;
+
+  raster->framebuffer = framebuffer;
+  raster->tiles_x = (framebuffer->w + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+  raster->tiles_y = (framebuffer->h + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+  raster->parallel = true;
+
+  raster->bins = calloc((size_t)raster->tiles_x * raster->tiles_y, sizeof(Raster_Bin));
+  if (!raster->bins) {
+    free(raster);
+    return NULL;
+  }
+
+  return raster;
+}
+
+void Raster_Destroy(Raster* raster) {
+  if (!raster) return;
+
+  for (int i = 0; i < raster->tiles_x * raster->tiles_y; i++) {
+    free(raster->bins[i].commands);
+  }
+  free(raster->bins);
+  free(raster->commands);
+  free(raster);
+}
+
+void Raster_SetParallel(Raster* raster, bool parallel) {
+  if (raster) raster->parallel = parallel;
+}
+
+static Raster_Command* internal_raster_push(Raster* raster) {
+  if (raster->command_count == raster->command_capacity) {
+    int capacity = raster->command_capacity ? raster->command_capacity * 2 : 256;
+    Raster_Command* commands = realloc(raster->commands, (size_t)capacity * sizeof(Raster_Command));
+    if (!commands) {
+      LOGGER_ERROR("Failed to grow raster command buffer\n");
+      return NULL;
+    }
+    raster->commands = commands;
+    raster->command_capacity = capacity;
+  }
+
+  return &raster->commands[raster->command_count++];
+}
+
+void Raster_Clear(Raster* raster, SDL_Color color) {
+  if (!raster) return;
+
+  // Anything queued before a full clear would be overwritten anyway.
+  raster->command_count = 0;
+
+  Raster_Command* command = internal_raster_push(raster);
+  if (!command) return;
+
+  command->type = RASTER_COMMAND_CLEAR;
+  command->color = ((uint32_t)color.a << 24) | ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+  command->bounds = (SDL_Rect){ 0, 0, raster->framebuffer->w, raster->framebuffer->h };
+}
+
+void Raster_DrawSprite(Raster* raster, SDL_Surface* sprite, const SDL_Rect* src, const SDL_Rect* dst, SDL_Color tint, SDL_BlendMode mode) {
+  if (!raster) return;
+
+  if (!internal_raster_is_argb(sprite)) {
+    LOGGER_ERROR("Raster_DrawSprite requires an ARGB8888 sprite\n");
+    return;
+  }
+
+  SDL_Rect sprite_rect = { 0, 0, sprite->w, sprite->h };
+  SDL_Rect src_rect = sprite_rect;
+  if (src && !SDL_IntersectRect(src, &sprite_rect, &src_rect)) return;
+
+  SDL_Rect dst_rect = dst ? *dst : (SDL_Rect){ 0, 0, src_rect.w, src_rect.h };
+  // A source hanging off the sprite is cropped, not stretched: the
+  // destination loses the same share on each side, as with SDL_RenderCopy.
+  if (src && dst && (src_rect.w != src->w || src_rect.h != src->h)) {
+    int x0 = (int)((int64_t)(src_rect.x - src->x) * dst->w / src->w);
+    int x1 = (int)((int64_t)(src_rect.x + src_rect.w - src->x) * dst->w / src->w);
+    int y0 = (int)((int64_t)(src_rect.y - src->y) * dst->h / src->h);
+    int y1 = (int)((int64_t)(src_rect.y + src_rect.h - src->y) * dst->h / src->h);
+    dst_rect = (SDL_Rect){ dst->x + x0, dst->y + y0, x1 - x0, y1 - y0 };
+  }
+
+  SDL_Rect fb_rect = { 0, 0, raster->framebuffer->w, raster->framebuffer->h };
+  SDL_Rect bounds;
+  if (!SDL_IntersectRect(&dst_rect, &fb_rect, &bounds)) return;
+
+  Raster_Command* command = internal_raster_push(raster);
+  if (!command) return;
+
+  command->type = RASTER_COMMAND_SPRITE;
+  command->mode = mode;
+  command->color = ((uint32_t)tint.a << 24) | ((uint32_t)tint.r << 16) | ((uint32_t)tint.g << 8) | tint.b;
+  command->sprite = sprite;
+  command->src = src_rect;
+  command->dst = dst_rect;
+  command->bounds = bounds;
+}
+
+static bool internal_raster_bin_push(Raster_Bin* bin, int command) {
+  if (bin->count == bin->capacity) {
+    int capacity = bin->capacity ? bin->capacity * 2 : 64;
+    int* commands = realloc(bin->commands, (size_t)capacity * sizeof(int));
+    if (!commands) return false;
+    bin->commands = commands;
+    bin->capacity = capacity;
+  }
+
+  bin->commands[bin->count++] = command;
+  return true;
+}
+
+static void internal_raster_bin_commands(Raster* raster) {
+  for (int i = 0; i < raster->tiles_x * raster->tiles_y; i++) {
+    raster->bins[i].count = 0;
+  }
+
+  for (int c = 0; c < raster->command_count; c++) {
+    const SDL_Rect* b = &raster->commands[c].bounds;
+    int tx0 = b->x / RASTER_TILE_SIZE;
+    int ty0 = b->y / RASTER_TILE_SIZE;
+    int tx1 = (b->x + b->w - 1) / RASTER_TILE_SIZE;
+    int ty1 = (b->y + b->h - 1) / RASTER_TILE_SIZE;
+
+    for (int ty = ty0; ty <= ty1; ty++) {
+      for (int tx = tx0; tx <= tx1; tx++) {
+        if (!internal_raster_bin_push(&raster->bins[ty * raster->tiles_x + tx], c)) {
+          LOGGER_ERROR("Failed to grow raster tile bin, dropping draw\n");
+        }
+      }
+    }
+  }
+}
+
+static void internal_raster_draw_clear(Raster* raster, const Raster_Command* command, const SDL_Rect* area) {
+  SDL_Surface* fb = raster->framebuffer;
+
+  for (int y = area->y; y < area->y + area->h; y++) {
+    uint32_t* row = (uint32_t*)((uint8_t*)fb->pixels + (size_t)y * fb->pitch) + area->x;
+    for (int x = 0; x < area->w; x++) row[x] = command->color;
+  }
+}
+
+static void internal_raster_draw_sprite(Raster* raster, const Raster_Kernels* kernels, const Raster_Command* command, const SDL_Rect* area) {
+  SDL_Surface* fb = raster->framebuffer;
+  SDL_Surface* sprite = command->sprite;
+  Raster_SpanFunction span = command->mode == SDL_BLENDMODE_NONE ? kernels->copy : kernels->blend;
+  uint32_t gather[RASTER_GATHER_SIZE];
+
+  // 16.16 fixed-point steps, sampling pixel centers (nearest neighbour).
+  int64_t du = ((int64_t)command->src.w << 16) / command->dst.w;
+  int64_t dv = ((int64_t)command->src.h << 16) / command->dst.h;
+
+  for (int y = area->y; y < area->y + area->h; y++) {
+    int64_t v = ((int64_t)command->src.y << 16) + (y - command->dst.y) * dv + (dv >> 1);
+    const uint32_t* src_row = (const uint32_t*)((const uint8_t*)sprite->pixels + (size_t)(v >> 16) * sprite->pitch);
+    uint32_t* dst_row = (uint32_t*)((uint8_t*)fb->pixels + (size_t)y * fb->pitch) + area->x;
+
+    if (du == (1 << 16)) {
+      span(dst_row, src_row + command->src.x + (area->x - command->dst.x), area->w, command->color);
+      continue;
+    }
+
+    int64_t u = ((int64_t)command->src.x << 16) + (area->x - command->dst.x) * du + (du >> 1);
+    for (int offset = 0; offset < area->w; offset += RASTER_GATHER_SIZE) {
+      int count = area->w - offset < RASTER_GATHER_SIZE ? area->w - offset : RASTER_GATHER_SIZE;
+      for (int i = 0; i < count; i++) {
+        gather[i] = src_row[u >> 16];
+        u += du;
+      }
+      span(dst_row + offset, gather, count, command->color);
+    }
+  }
+}
+
+static void internal_raster_render_tile(Raster* raster, const Raster_Kernels* kernels, int tile) {
+  const Raster_Bin* bin = &raster->bins[tile];
+  if (bin->count == 0) return;
+
+  SDL_Rect tile_rect = {
+    (tile % raster->tiles_x) * RASTER_TILE_SIZE,
+    (tile / raster->tiles_x) * RASTER_TILE_SIZE,
+    RASTER_TILE_SIZE,
+    RASTER_TILE_SIZE
+  };
+
+  for (int i = 0; i < bin->count; i++) {
+    const Raster_Command* command = &raster->commands[bin->commands[i]];
+    SDL_Rect area;
+    if (!SDL_IntersectRect(&command->bounds, &tile_rect, &area)) continue;
+
+    if (command->type == RASTER_COMMAND_CLEAR) {
+      internal_raster_draw_clear(raster, command, &area);
+    } else {
+      internal_raster_draw_sprite(raster, kernels, command, &area);
+    }
+  }
+}
+
+typedef struct {
+  Raster* raster;
+  Raster_Kernels kernels;
+} Raster_TileJob;
+
+static void internal_raster_render_tiles(int begin, int end, void* data) {
+  Raster_TileJob* job = data;
+  for (int tile = begin; tile < end; tile++) {
+    internal_raster_render_tile(job->raster, &job->kernels, tile);
+  }
+}
+
+void Raster_Flush(Raster* raster) {
+  if (!raster || raster->command_count == 0) return;
+
+  internal_raster_bin_commands(raster);
+
+  if (SDL_LockSurface(raster->framebuffer) != 0) {
+    LOGGER_ERROR("Failed to lock raster framebuffer: %s\n", SDL_GetError());
+    raster->command_count = 0;
+    return;
+  }
+
+  Raster_TileJob job = { raster, internal_raster_kernels() };
+  int tile_count = raster->tiles_x * raster->tiles_y;
+
+  // Tiles never overlap, so each one can be rendered without synchronization.
+  if (raster->parallel) {
+    Jobs_ParallelFor(tile_count, 1, internal_raster_render_tiles, &job);
+  } else {
+    internal_raster_render_tiles(0, tile_count, &job);
+  }
+
+  SDL_UnlockSurface(raster->framebuffer);
+  raster->command_count = 0;
+}
+
+
+/* ---- Benchmark ---- */
+
+#define RASTER_BENCH_WIDTH 1280
+#define RASTER_BENCH_HEIGHT 720
+#define RASTER_BENCH_SPRITES 4000
+#define RASTER_BENCH_FRAMES 30
+
+typedef struct {
+  SDL_Rect dst;
+  SDL_Color tint;
+} Raster_BenchSprite;
+
+static SDL_Surface* internal_raster_bench_sprite(void) {
+  SDL_Surface* sprite = SDL_CreateRGBSurfaceWithFormat(0, 32, 32, 32, SDL_PIXELFORMAT_ARGB8888);
+  if (!sprite) return NULL;
+
+  for (int y = 0; y < sprite->h; y++) {
+    uint32_t* row = (uint32_t*)((uint8_t*)sprite->pixels + (size_t)y * sprite->pitch);
+    for (int x = 0; x < sprite->w; x++) {
+      int dx = x - 16, dy = y - 16;
+      int alpha = 255 - (dx * dx + dy * dy);
+      if (alpha < 0) alpha = 0;
+      row[x] = ((uint32_t)alpha << 24) | ((uint32_t)(x * 8) << 16) | ((uint32_t)(y * 8) << 8) | 0x80;
+    }
+  }
+
+  return sprite;
+}
+
+static double internal_raster_bench_seconds(uint64_t start) {
+  return (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+static void internal_raster_bench_engine(SDL_Surface* fb, SDL_Surface* sprite, const Raster_BenchSprite* sprites, Raster_Kernel kernel, bool parallel) {
+  if (!Raster_ForceKernel(kernel)) return;
+
+  Raster* raster = Raster_Create(fb);
+  if (!raster) return;
+  Raster_SetParallel(raster, parallel);
+
+  uint64_t start = SDL_GetPerformanceCounter();
+  for (int frame = 0; frame < RASTER_BENCH_FRAMES; frame++) {
+    Raster_Clear(raster, (SDL_Color){ 0, 0, 0, 255 });
+    for (int i = 0; i < RASTER_BENCH_SPRITES; i++) {
+      Raster_DrawSprite(raster, sprite, NULL, &sprites[i].dst, sprites[i].tint, SDL_BLENDMODE_BLEND);
+    }
+    Raster_Flush(raster);
+  }
+  double seconds = internal_raster_bench_seconds(start);
+
+  LOGGER_INFO("Raster %-6s %-8s: %10.0f sprites/s (%.3f ms/frame)\n",
+    Raster_KernelName(kernel), parallel ? "parallel" : "single",
+    RASTER_BENCH_SPRITES * RASTER_BENCH_FRAMES / seconds, seconds * 1000.0 / RASTER_BENCH_FRAMES);
+
+  Raster_Destroy(raster);
+}
+
+static void internal_raster_bench_sdl(SDL_Surface* fb, SDL_Surface* sprite, const Raster_BenchSprite* sprites) {
+  SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(fb);
+  if (!renderer) {
+    LOGGER_ERROR("SDL_CreateSoftwareRenderer Error: %s\n", SDL_GetError());
+    return;
+  }
+
+  SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, sprite);
+  if (!texture) {
+    LOGGER_ERROR("SDL_CreateTextureFromSurface Error: %s\n", SDL_GetError());
+    SDL_DestroyRenderer(renderer);
+    return;
+  }
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+  uint64_t start = SDL_GetPerformanceCounter();
+  for (int frame = 0; frame < RASTER_BENCH_FRAMES; frame++) {
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    for (int i = 0; i < RASTER_BENCH_SPRITES; i++) {
+      SDL_SetTextureColorMod(texture, sprites[i].tint.r, sprites[i].tint.g, sprites[i].tint.b);
+      SDL_SetTextureAlphaMod(texture, sprites[i].tint.a);
+      SDL_RenderCopy(renderer, texture, NULL, &sprites[i].dst);
+    }
+    SDL_RenderFlush(renderer);
+  }
+  double seconds = internal_raster_bench_seconds(start);
+
+  LOGGER_INFO("SDL software renderer  : %10.0f sprites/s (%.3f ms/frame)\n",
+    RASTER_BENCH_SPRITES * RASTER_BENCH_FRAMES / seconds, seconds * 1000.0 / RASTER_BENCH_FRAMES);
+
+  SDL_DestroyTexture(texture);
+  SDL_DestroyRenderer(renderer);
+}
+
+void Raster_Benchmark(void) {
+  SDL_Surface* fb = SDL_CreateRGBSurfaceWithFormat(0, RASTER_BENCH_WIDTH, RASTER_BENCH_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+  SDL_Surface* sprite = internal_raster_bench_sprite();
+  Raster_BenchSprite* sprites = malloc(RASTER_BENCH_SPRITES * sizeof(Raster_BenchSprite));
+
+  if (!fb || !sprite || !sprites) {
+    LOGGER_ERROR("Failed to allocate raster benchmark resources\n");
+    free(sprites);
+    if (sprite) SDL_FreeSurface(sprite);
+    if (fb) SDL_FreeSurface(fb);
+    return;
+  }
+
+  // Deterministic layout: half the sprites unscaled, half scaled to 48x48.
+  uint32_t seed = 0x12345678u;
+  for (int i = 0; i < RASTER_BENCH_SPRITES; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    int size = (i & 1) ? 48 : 32;
+    sprites[i].dst = (SDL_Rect){ (int)(seed % (RASTER_BENCH_WIDTH - size)), (int)((seed >> 12) % (RASTER_BENCH_HEIGHT - size)), size, size };
+    sprites[i].tint = (SDL_Color){ (Uint8)(seed >> 8), (Uint8)(seed >> 16), 255, (i % 3) ? 255 : 160 };
+  }
+
+  LOGGER_INFO("Raster benchmark: %d sprites, %dx%d, %d frames, %d job workers\n",
+    RASTER_BENCH_SPRITES, RASTER_BENCH_WIDTH, RASTER_BENCH_HEIGHT, RASTER_BENCH_FRAMES, Jobs_GetWorkerCount());
+
+  Raster_Kernel detected = Raster_GetKernel();
+  const Raster_Kernel kernels[] = { RASTER_KERNEL_SCALAR, RASTER_KERNEL_SSE2, RASTER_KERNEL_AVX2 };
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+    internal_raster_bench_engine(fb, sprite, sprites, kernels[i], false);
+    internal_raster_bench_engine(fb, sprite, sprites, kernels[i], true);
+  }
+  Raster_ForceKernel(detected);
+
+  internal_raster_bench_sdl(fb, sprite, sprites);
+
+  free(sprites);
+  SDL_FreeSurface(sprite);
+  SDL_FreeSurface(fb);
+}
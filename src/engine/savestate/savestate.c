@@ -0,0 +1,937 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <engine/savestate/savestate.h>
+#include <engine/constants.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+#include <utils/utilities.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <SDL2/SDL.h>
+
+#define SAVESTATE_MAGIC "BABYSAVE"
+#define SAVESTATE_FORMAT_VERSION 1
+#define SAVESTATE_ENDIAN_MARK 0x01020304u // Reads back differently on a foreign byte order
+#define SAVESTATE_FLAG_COMPRESSED 1u
+#define SAVESTATE_DIRECTORY "saves"
+#define SAVESTATE_PATH_SIZE 1024
+
+#define SAVESTATE_LZ_HASH_BITS 14
+#define SAVESTATE_LZ_MIN_MATCH 4
+#define SAVESTATE_LZ_MAX_OFFSET 65535
+#define SAVESTATE_LZ_TAIL 12 // Matching stops this far from the end so the finder never overreads
+#define SAVESTATE_LZ_MAX_INPUT 0x7fffffffu
+
+// On-disk layout, native byte order: one file header, the section table,
+// then every section at a SAVESTATE_ALIGNMENT offset. Both headers are one
+// cache line so the table itself stays aligned.
+typedef struct {
+  char magic[8];
+  uint32_t format_version;
+  uint32_t endian_mark;
+  uint64_t chain_id;      // Shared by a full snapshot and its deltas
+  uint32_t sequence;      // 0 for the full snapshot, n for its n-th delta
+  uint32_t section_count;
+  uint64_t file_size;
+  uint8_t reserved[24];
+} Savestate_FileHeader;
+
+typedef struct {
+  uint32_t id;
+  uint32_t version;
+  uint32_t flags;
+  uint32_t reserved;
+  char name[SAVESTATE_NAME_SIZE];
+  uint64_t offset;      // From the start of the file
+  uint64_t size;        // Of the image
+  uint64_t stored_size; // Bytes in the file, smaller than size when compressed
+  uint64_t hash;        // Of the image, also catches torn or corrupted files
+} Savestate_SectionHeader;
+
+_Static_assert(sizeof(Savestate_FileHeader) == SAVESTATE_ALIGNMENT, "file header must be one alignment unit");
+_Static_assert(sizeof(Savestate_SectionHeader) == SAVESTATE_ALIGNMENT, "section header must be one alignment unit");
+
+typedef struct {
+  uint32_t id;
+  uint32_t version;
+  char name[SAVESTATE_NAME_SIZE];
+  void* data;
+  size_t size;
+  Savestate_Fixup fixup;
+  void* user;
+
+  size_t staged_offset; // In the staging buffer
+  uint64_t saved_hash;  // Of the newest durable copy, writer owned
+  bool saved;
+} Savestate_Section;
+
+typedef struct {
+  uint8_t* base;
+  size_t size;
+  const Savestate_FileHeader* header;
+  const Savestate_SectionHeader* sections;
+} Savestate_Mapping;
+
+struct Savestate {
+  char* prefix; // Directory and file stem
+
+  Savestate_Section sections[SAVESTATE_MAX_SECTIONS];
+  int section_count;
+
+  // Filled by the game thread while the writer is idle, read by the writer.
+  uint8_t* staging;
+  size_t staging_capacity;
+  int staged_count;
+  bool staged_full;
+
+  // Writer owned; the game thread only reads them while the writer is idle.
+  uint8_t* compressed;
+  size_t compressed_capacity;
+  uint32_t* lz_table;
+  uint64_t chain_id;
+  uint32_t sequence;
+  bool has_chain;
+
+  pthread_t writer;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool pending;
+  bool stopping;
+  bool succeeded;
+  atomic_bool busy;
+
+  Metrics_Histogram* capture_metric;
+  Metrics_Histogram* write_metric;
+  Metrics_Counter* bytes_metric;
+  Metrics_Gauge* pending_metric;
+};
+
+static inline size_t internal_savestate_align(size_t value) {
+  return (value + SAVESTATE_ALIGNMENT - 1) & ~(size_t)(SAVESTATE_ALIGNMENT - 1);
+}
+
+/* ---- Hashing ---- */
+
+#define SAVESTATE_PRIME1 UINT64_C(0x9E3779B185EBCA87)
+#define SAVESTATE_PRIME2 UINT64_C(0xC2B2AE3D27D4EB4F)
+#define SAVESTATE_PRIME3 UINT64_C(0x165667B19E3779F9)
+#define SAVESTATE_PRIME4 UINT64_C(0x85EBCA77C2B2AE63)
+
+static inline uint64_t internal_savestate_rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t internal_savestate_read64(const uint8_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint64_t internal_savestate_round(uint64_t lane, uint64_t word) {
+  return internal_savestate_rotl(lane + word * SAVESTATE_PRIME2, 31) * SAVESTATE_PRIME1;
+}
+
+// Four independent lanes keep the multipliers busy, so hashing a section
+// costs about as much as reading it.
+static uint64_t internal_savestate_hash(const uint8_t* data, size_t size) {
+  const uint8_t* p = data;
+  const uint8_t* end = data + size;
+  uint64_t hash;
+
+  if (size >= 32) {
+    uint64_t v1 = SAVESTATE_PRIME1 + SAVESTATE_PRIME2;
+    uint64_t v2 = SAVESTATE_PRIME2;
+    uint64_t v3 = 0;
+    uint64_t v4 = (uint64_t)0 - SAVESTATE_PRIME1;
+    for (; p + 32 <= end; p += 32) {
+      v1 = internal_savestate_round(v1, internal_savestate_read64(p));
+      v2 = internal_savestate_round(v2, internal_savestate_read64(p + 8));
+      v3 = internal_savestate_round(v3, internal_savestate_read64(p + 16));
+      v4 = internal_savestate_round(v4, internal_savestate_read64(p + 24));
+    }
+    hash = internal_savestate_rotl(v1, 1) + internal_savestate_rotl(v2, 7) +
+      internal_savestate_rotl(v3, 12) + internal_savestate_rotl(v4, 18);
+  } else {
+    hash = SAVESTATE_PRIME3;
+  }
+
+  hash += (uint64_t)size;
+  for (; p + 8 <= end; p += 8) {
+    hash ^= internal_savestate_round(0, internal_savestate_read64(p));
+    hash = internal_savestate_rotl(hash, 27) * SAVESTATE_PRIME1 + SAVESTATE_PRIME4;
+  }
+  for (; p < end; p++) {
+    hash ^= *p * SAVESTATE_PRIME3;
+    hash = internal_savestate_rotl(hash, 11) * SAVESTATE_PRIME1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= SAVESTATE_PRIME2;
+  hash ^= hash >> 29;
+  hash *= SAVESTATE_PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+/* ---- Compression ---- */
+
+// A byte-oriented LZ77 in the spirit of LZ4: each sequence is a token with
+// the literal and match lengths, the literals, and a 16-bit match offset.
+// The final sequence carries literals only.
+
+static inline uint32_t internal_savestate_read32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static size_t internal_savestate_lz_bound(size_t size) {
+  return size + size / 255 + 16;
+}
+
+static bool internal_savestate_lz_length(uint8_t** out, const uint8_t* out_end, size_t length) {
+  for (; length >= 255; length -= 255) {
+    if (*out >= out_end) return false;
+    *(*out)++ = 255;
+  }
+  if (*out >= out_end) return false;
+  *(*out)++ = (uint8_t)length;
+  return true;
+}
+
+static bool internal_savestate_lz_emit(uint8_t** out, const uint8_t* out_end, const uint8_t* literals,
+  size_t literal_length, size_t offset, size_t match_length) {
+  if (*out >= out_end) return false;
+  size_t match_code = match_length ? match_length - SAVESTATE_LZ_MIN_MATCH : 0;
+  uint8_t* token = (*out)++;
+  *token = (uint8_t)((literal_length < 15 ? literal_length : 15) << 4 | (match_code < 15 ? match_code : 15));
+
+  if (literal_length >= 15 && !internal_savestate_lz_length(out, out_end, literal_length - 15)) return false;
+  if ((size_t)(out_end - *out) < literal_length) return false;
+  memcpy(*out, literals, literal_length);
+  *out += literal_length;
+
+  if (!match_length) return true;
+  if (out_end - *out < 2) return false;
+  *(*out)++ = (uint8_t)offset;
+  *(*out)++ = (uint8_t)(offset >> 8);
+  return match_code < 15 || internal_savestate_lz_length(out, out_end, match_code - 15);
+}
+
+// Returns the compressed size, or 0 when the output would not fit.
+static size_t internal_savestate_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity, uint32_t* table) {
+  if (size > SAVESTATE_LZ_MAX_INPUT) return 0;
+  memset(table, 0, sizeof(uint32_t) << SAVESTATE_LZ_HASH_BITS);
+
+  uint8_t* out = dst;
+  const uint8_t* out_end = dst + capacity;
+  size_t anchor = 0;
+  size_t ip = 0;
+  size_t limit = size > SAVESTATE_LZ_TAIL ? size - SAVESTATE_LZ_TAIL : 0;
+
+  while (ip < limit) {
+    uint32_t sequence = internal_savestate_read32(src + ip);
+    uint32_t slot = (sequence * 2654435761u) >> (32 - SAVESTATE_LZ_HASH_BITS);
+    size_t candidate = table[slot];
+    table[slot] = (uint32_t)ip + 1; // 0 marks an empty slot
+
+    if (!candidate || ip - (candidate - 1) > SAVESTATE_LZ_MAX_OFFSET ||
+        internal_savestate_read32(src + candidate - 1) != sequence) {
+      ip += 1 + ((ip - anchor) >> 6); // Skip faster through incompressible runs
+      continue;
+    }
+
+    size_t match = candidate - 1;
+    size_t length = SAVESTATE_LZ_MIN_MATCH;
+    size_t max_length = limit + SAVESTATE_LZ_TAIL / 2 - ip;
+    while (length < max_length && src[match + length] == src[ip + length]) length++;
+
+    if (!internal_savestate_lz_emit(&out, out_end, src + anchor, ip - anchor, ip - match, length)) return 0;
+    ip += length;
+    anchor = ip;
+  }
+
+  if (!internal_savestate_lz_emit(&out, out_end, src + anchor, size - anchor, 0, 0)) return 0;
+  return (size_t)(out - dst);
+}
+
+// Checks every length and offset, so a corrupted file fails instead of
+// writing out of bounds.
+static bool internal_savestate_decompress(const uint8_t* src, size_t stored_size, uint8_t* dst, size_t size) {
+  const uint8_t* in = src;
+  const uint8_t* in_end = src + stored_size;
+  uint8_t* out = dst;
+  uint8_t* out_end = dst + size;
+
+  while (in < in_end) {
+    uint8_t token = *in++;
+
+    size_t literal_length = token >> 4;
+    if (literal_length == 15) {
+      uint8_t byte;
+      do {
+        if (in >= in_end) return false;
+        byte = *in++;
+        literal_length += byte;
+      } while (byte == 255);
+    }
+    if ((size_t)(in_end - in) < literal_length || (size_t)(out_end - out) < literal_length) return false;
+    memcpy(out, in, literal_length);
+    in += literal_length;
+    out += literal_length;
+
+    if (in == in_end) break; // The final sequence has no match
+
+    if (in_end - in < 2) return false;
+    size_t offset = (size_t)in[0] | (size_t)in[1] << 8;
+    in += 2;
+    size_t match_length = (token & 15);
+    if (match_length == 15) {
+      uint8_t byte;
+      do {
+        if (in >= in_end) return false;
+        byte = *in++;
+        match_length += byte;
+      } while (byte == 255);
+    }
+    match_length += SAVESTATE_LZ_MIN_MATCH;
+
+    if (offset == 0 || offset > (size_t)(out - dst) || (size_t)(out_end - out) < match_length) return false;
+    const uint8_t* match = out - offset;
+    if (offset >= match_length) {
+      memcpy(out, match, match_length);
+      out += match_length;
+    } else {
+      for (size_t i = 0; i < match_length; i++) *out++ = match[i]; // Overlapping runs
+    }
+  }
+
+  return out == out_end;
+}
+
+/* ---- Files ---- */
+
+static void internal_savestate_path(const Savestate* saver, uint32_t sequence, bool temporary, char* path, size_t size) {
+  if (sequence == 0) {
+    snprintf(path, size, "%s.sav%s", saver->prefix, temporary ? ".tmp" : "");
+  } else {
+    snprintf(path, size, "%s.%u.delta%s", saver->prefix, sequence, temporary ? ".tmp" : "");
+  }
+}
+
+static bool internal_savestate_pwrite(int fd, const void* data, size_t size, uint64_t offset) {
+  const uint8_t* p = data;
+  while (size > 0) {
+    ssize_t written = pwrite(fd, p, size, (off_t)offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    p += written;
+    size -= (size_t)written;
+    offset += (uint64_t)written;
+  }
+  return true;
+}
+
+// The rename is only durable once the directory entry reaches the disk.
+static bool internal_savestate_sync_directory(const char* path) {
+  char directory[SAVESTATE_PATH_SIZE];
+  snprintf(directory, sizeof(directory), "%s", path);
+  char* slash = strrchr(directory, '/');
+  if (!slash) return true;
+  *slash = '\0';
+
+  int fd = open(directory, O_RDONLY);
+  if (fd < 0) return false;
+  bool ok = fsync(fd) == 0;
+  close(fd);
+  return ok;
+}
+
+static uint64_t internal_savestate_chain_id(void) {
+  static atomic_uint_fast64_t counter;
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  uint64_t seed[3] = { (uint64_t)now.tv_sec, (uint64_t)now.tv_nsec, atomic_fetch_add(&counter, 1) };
+  return internal_savestate_hash((const uint8_t*)seed, sizeof(seed)) | 1; // Never 0
+}
+
+static bool internal_savestate_grow(uint8_t** buffer, size_t* capacity, size_t size) {
+  if (size <= *capacity) return true;
+
+  size_t grown = internal_savestate_align(size + size / 4);
+  uint8_t* resized = aligned_alloc(SAVESTATE_ALIGNMENT, grown);
+  if (!resized) return false;
+  free(*buffer);
+  *buffer = resized;
+  *capacity = grown;
+  return true;
+}
+
+/* ---- Writer ---- */
+
+static bool internal_savestate_write(Savestate* saver) {
+  uint64_t start = SDL_GetPerformanceCounter();
+  bool full = saver->staged_full;
+  uint64_t chain_id = full ? internal_savestate_chain_id() : saver->chain_id;
+  uint32_t sequence = full ? 0 : saver->sequence + 1;
+
+  uint64_t hashes[SAVESTATE_MAX_SECTIONS];
+  int indices[SAVESTATE_MAX_SECTIONS];
+  int count = 0;
+  for (int i = 0; i < saver->staged_count; i++) {
+    Savestate_Section* section = &saver->sections[i];
+    hashes[i] = internal_savestate_hash(saver->staging + section->staged_offset, section->size);
+    if (full || !section->saved || section->saved_hash != hashes[i]) indices[count++] = i;
+  }
+  if (count == 0) return true; // Nothing changed since the last save
+
+  char path[SAVESTATE_PATH_SIZE];
+  char temporary[SAVESTATE_PATH_SIZE];
+  internal_savestate_path(saver, sequence, false, path, sizeof(path));
+  internal_savestate_path(saver, sequence, true, temporary, sizeof(temporary));
+
+  int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOGGER_ERROR("Failed to create save file %s: %s\n", temporary, strerror(errno));
+    return false;
+  }
+
+  Savestate_FileHeader header = {0};
+  Savestate_SectionHeader table[SAVESTATE_MAX_SECTIONS];
+  memset(table, 0, sizeof(table));
+  uint64_t offset = internal_savestate_align(sizeof(header) + (size_t)count * sizeof(Savestate_SectionHeader));
+  uint64_t end = offset;
+  bool ok = true;
+
+  // Payloads first, then the table that describes them.
+  for (int k = 0; k < count && ok; k++) {
+    const Savestate_Section* section = &saver->sections[indices[k]];
+    const uint8_t* image = saver->staging + section->staged_offset;
+    Savestate_SectionHeader* entry = &table[k];
+
+    entry->id = section->id;
+    entry->version = section->version;
+    memcpy(entry->name, section->name, SAVESTATE_NAME_SIZE);
+    entry->offset = offset;
+    entry->size = section->size;
+    entry->hash = hashes[indices[k]];
+
+    // Only keep the compressed copy when it saves at least an eighth.
+    size_t worthwhile = section->size - section->size / 8;
+    size_t stored = 0;
+    if (internal_savestate_grow(&saver->compressed, &saver->compressed_capacity, internal_savestate_lz_bound(section->size))) {
+      stored = internal_savestate_compress(image, section->size, saver->compressed, worthwhile, saver->lz_table);
+    }
+
+    if (stored > 0) {
+      entry->flags = SAVESTATE_FLAG_COMPRESSED;
+      entry->stored_size = stored;
+      ok = internal_savestate_pwrite(fd, saver->compressed, stored, offset);
+    } else {
+      entry->stored_size = section->size;
+      ok = internal_savestate_pwrite(fd, image, section->size, offset);
+    }
+
+    end = offset + entry->stored_size;
+    offset = internal_savestate_align(end);
+  }
+
+  memcpy(header.magic, SAVESTATE_MAGIC, sizeof(header.magic));
+  header.format_version = SAVESTATE_FORMAT_VERSION;
+  header.endian_mark = SAVESTATE_ENDIAN_MARK;
+  header.chain_id = chain_id;
+  header.sequence = sequence;
+  header.section_count = (uint32_t)count;
+  header.file_size = end;
+
+  ok = ok && internal_savestate_pwrite(fd, &header, sizeof(header), 0);
+  ok = ok && internal_savestate_pwrite(fd, table, (size_t)count * sizeof(Savestate_SectionHeader), sizeof(header));
+  ok = ok && fsync(fd) == 0;
+  if (close(fd) != 0) ok = false;
+  ok = ok && rename(temporary, path) == 0;
+
+  if (!ok) {
+    LOGGER_ERROR("Failed to write save file %s: %s\n", path, strerror(errno));
+    unlink(temporary);
+    return false;
+  }
+  if (!internal_savestate_sync_directory(path)) {
+    LOGGER_WARN("Failed to sync the directory of %s: %s\n", path, strerror(errno));
+  }
+
+  for (int k = 0; k < count; k++) {
+    Savestate_Section* section = &saver->sections[indices[k]];
+    section->saved_hash = hashes[indices[k]];
+    section->saved = true;
+  }
+
+  // Deltas of the old chain no longer match its chain id; drop them.
+  if (full) {
+    for (uint32_t stale = 1; stale <= SAVESTATE_MAX_DELTAS; stale++) {
+      internal_savestate_path(saver, stale, false, path, sizeof(path));
+      unlink(path);
+    }
+  }
+
+  saver->chain_id = chain_id;
+  saver->sequence = sequence;
+  saver->has_chain = true;
+
+  double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+  Metrics_HistogramObserve(saver->write_metric, ms);
+  Metrics_CounterAdd(saver->bytes_metric, end);
+  LOGGER_DEBUG("Saved %s %u: %d sections, %llu bytes in %.2f ms\n", full ? "snapshot" : "delta",
+    sequence, count, (unsigned long long)end, ms);
+  return true;
+}
+
+static void* internal_savestate_writer_main(void* arg) {
+  Savestate* saver = arg;
+
+  pthread_mutex_lock(&saver->mutex);
+  for (;;) {
+    while (!saver->pending && !saver->stopping) pthread_cond_wait(&saver->cond, &saver->mutex);
+    if (!saver->pending) break;
+
+    pthread_mutex_unlock(&saver->mutex);
+    bool ok = internal_savestate_write(saver);
+    pthread_mutex_lock(&saver->mutex);
+
+    saver->pending = false;
+    saver->succeeded = ok;
+    atomic_store_explicit(&saver->busy, false, memory_order_release);
+    Metrics_GaugeAdd(saver->pending_metric, -1);
+    pthread_cond_broadcast(&saver->cond);
+  }
+  pthread_mutex_unlock(&saver->mutex);
+  return NULL;
+}
+
+/* ---- Public API ---- */
+
+Savestate* Savestate_Create(const char* name) {
+  if (!name || !*name || strchr(name, '/') || !GAME_ROOT_PATH) return NULL;
+
+  Savestate* saver = calloc(1, sizeof(Savestate));
+  if (!saver) return NULL;
+
+  char* directory = path_join(GAME_ROOT_PATH, SAVESTATE_DIRECTORY);
+  if (directory) {
+    makedir(directory);
+    saver->prefix = path_join(directory, name);
+    free(directory);
+  }
+  saver->lz_table = malloc(sizeof(uint32_t) << SAVESTATE_LZ_HASH_BITS);
+  if (!saver->prefix || !saver->lz_table) {
+    free(saver->prefix);
+    free(saver->lz_table);
+    free(saver);
+    return NULL;
+  }
+
+  pthread_mutex_init(&saver->mutex, NULL);
+  pthread_cond_init(&saver->cond, NULL);
+  saver->succeeded = true;
+  atomic_init(&saver->busy, false);
+
+  if (pthread_create(&saver->writer, NULL, internal_savestate_writer_main, saver) != 0) {
+    LOGGER_ERROR("Failed to start the save writer thread\n");
+    pthread_mutex_destroy(&saver->mutex);
+    pthread_cond_destroy(&saver->cond);
+    free(saver->prefix);
+    free(saver->lz_table);
+    free(saver);
+    return NULL;
+  }
+
+  static const double capture_bounds[] = { 0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.7 };
+  static const double write_bounds[] = { 1.0, 5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 1000.0 };
+  saver->capture_metric = Metrics_RegisterHistogram("savestate_capture_ms", capture_bounds,
+    (int)(sizeof(capture_bounds) / sizeof(capture_bounds[0])));
+  saver->write_metric = Metrics_RegisterHistogram("savestate_write_ms", write_bounds,
+    (int)(sizeof(write_bounds) / sizeof(write_bounds[0])));
+  saver->bytes_metric = Metrics_RegisterCounter("savestate_written_bytes_total");
+  saver->pending_metric = Metrics_RegisterGauge("savestate_pending_writes");
+
+  return saver;
+}
+
+void Savestate_Destroy(Savestate* saver) {
+  if (!saver) return;
+
+  pthread_mutex_lock(&saver->mutex);
+  saver->stopping = true;
+  pthread_cond_broadcast(&saver->cond);
+  pthread_mutex_unlock(&saver->mutex);
+  pthread_join(saver->writer, NULL); // Finishes the pending write first
+
+  pthread_mutex_destroy(&saver->mutex);
+  pthread_cond_destroy(&saver->cond);
+  free(saver->staging);
+  free(saver->compressed);
+  free(saver->lz_table);
+  free(saver->prefix);
+  free(saver);
+}
+
+bool Savestate_AddSection(Savestate* saver, uint32_t id, const char* name, uint32_t version,
+  void* data, size_t size, Savestate_Fixup fixup, void* user) {
+  if (!saver || !data || size == 0 || saver->section_count >= SAVESTATE_MAX_SECTIONS) return false;
+
+  for (int i = 0; i < saver->section_count; i++) {
+    if (saver->sections[i].id == id) {
+      LOGGER_ERROR("Save section %u is already registered\n", id);
+      return false;
+    }
+  }
+
+  // The writer reads only the sections of the capture it is writing, so
+  // appending never races it.
+  Savestate_Section* section = &saver->sections[saver->section_count];
+  memset(section, 0, sizeof(*section));
+  section->id = id;
+  section->version = version;
+  snprintf(section->name, SAVESTATE_NAME_SIZE, "%s", name ? name : "");
+  section->data = data;
+  section->size = size;
+  section->fixup = fixup;
+  section->user = user;
+  saver->section_count++;
+  return true;
+}
+
+static bool internal_savestate_capture(Savestate* saver, bool full) {
+  if (!saver || saver->section_count == 0) return false;
+
+  pthread_mutex_lock(&saver->mutex);
+  bool pending = saver->pending;
+  pthread_mutex_unlock(&saver->mutex);
+  if (pending) return false;
+
+  uint64_t start = SDL_GetPerformanceCounter();
+
+  size_t total = 0;
+  for (int i = 0; i < saver->section_count; i++) {
+    saver->sections[i].staged_offset = total;
+    total += internal_savestate_align(saver->sections[i].size);
+  }
+  if (!internal_savestate_grow(&saver->staging, &saver->staging_capacity, total)) {
+    LOGGER_ERROR("Failed to allocate %llu bytes of save staging\n", (unsigned long long)total);
+    return false;
+  }
+
+  // One straight copy per section is all the frame pays; the writer does
+  // the rest from the staging buffer.
+  for (int i = 0; i < saver->section_count; i++) {
+    const Savestate_Section* section = &saver->sections[i];
+    memcpy(saver->staging + section->staged_offset, section->data, section->size);
+  }
+
+  saver->staged_count = saver->section_count;
+  saver->staged_full = full || !saver->has_chain || saver->sequence >= SAVESTATE_MAX_DELTAS;
+
+  Metrics_HistogramObserve(saver->capture_metric,
+    (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency());
+  Metrics_GaugeAdd(saver->pending_metric, 1);
+
+  pthread_mutex_lock(&saver->mutex);
+  saver->pending = true;
+  atomic_store_explicit(&saver->busy, true, memory_order_relaxed);
+  pthread_cond_broadcast(&saver->cond);
+  pthread_mutex_unlock(&saver->mutex);
+  return true;
+}
+
+bool Savestate_Save(Savestate* saver) {
+  return internal_savestate_capture(saver, false);
+}
+
+bool Savestate_SaveFull(Savestate* saver) {
+  return internal_savestate_capture(saver, true);
+}
+
+bool Savestate_IsBusy(const Savestate* saver) {
+  return saver && atomic_load_explicit(&saver->busy, memory_order_acquire);
+}
+
+bool Savestate_Wait(Savestate* saver) {
+  if (!saver) return false;
+
+  pthread_mutex_lock(&saver->mutex);
+  while (saver->pending) pthread_cond_wait(&saver->cond, &saver->mutex);
+  bool succeeded = saver->succeeded;
+  pthread_mutex_unlock(&saver->mutex);
+  return succeeded;
+}
+
+/* ---- Loading ---- */
+
+static bool internal_savestate_map(const char* path, Savestate_Mapping* mapping) {
+  memset(mapping, 0, sizeof(*mapping));
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(Savestate_FileHeader)) {
+    close(fd);
+    return false;
+  }
+
+  // Private and writable, so fixups may patch images without touching the file.
+  size_t size = (size_t)info.st_size;
+  void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return false;
+
+  mapping->base = base;
+  mapping->size = size;
+  mapping->header = base;
+  mapping->sections = (const Savestate_SectionHeader*)((uint8_t*)base + sizeof(Savestate_FileHeader));
+
+  const Savestate_FileHeader* header = mapping->header;
+  bool valid = memcmp(header->magic, SAVESTATE_MAGIC, sizeof(header->magic)) == 0 &&
+    header->format_version == SAVESTATE_FORMAT_VERSION &&
+    header->endian_mark == SAVESTATE_ENDIAN_MARK &&
+    header->file_size == size &&
+    header->section_count <= SAVESTATE_MAX_SECTIONS &&
+    sizeof(Savestate_FileHeader) + header->section_count * sizeof(Savestate_SectionHeader) <= size;
+
+  for (uint32_t i = 0; valid && i < header->section_count; i++) {
+    const Savestate_SectionHeader* entry = &mapping->sections[i];
+    bool compressed = entry->flags & SAVESTATE_FLAG_COMPRESSED;
+    valid = entry->offset % SAVESTATE_ALIGNMENT == 0 &&
+      entry->offset <= size && entry->stored_size <= size - entry->offset &&
+      // The compressor never takes more than SAVESTATE_LZ_MAX_INPUT, and the
+      // cap keeps the inflated size from wrapping when aligned.
+      (compressed ? entry->stored_size < entry->size && entry->size <= SAVESTATE_LZ_MAX_INPUT
+                  : entry->stored_size == entry->size);
+  }
+
+  if (!valid) {
+    LOGGER_WARN("Ignoring invalid save file %s\n", path);
+    munmap(base, size);
+    memset(mapping, 0, sizeof(*mapping));
+  }
+  return valid;
+}
+
+static const Savestate_SectionHeader* internal_savestate_find(const Savestate_Mapping* mapping, uint32_t id) {
+  for (uint32_t i = 0; i < mapping->header->section_count; i++) {
+    if (mapping->sections[i].id == id) return &mapping->sections[i];
+  }
+  return NULL;
+}
+
+static bool internal_savestate_apply(Savestate_Section* section, const Savestate_Mapping* mapping,
+  const Savestate_SectionHeader* entry) {
+  uint8_t* image = mapping->base + entry->offset;
+  uint8_t* inflated = NULL;
+
+  // Decided before inflating, so an image nothing can use costs no allocation.
+  if (!section->fixup && (entry->size != section->size || entry->version != section->version)) {
+    LOGGER_WARN("Save section %s changed layout (version %u, %llu bytes) and has no fixup, skipped\n",
+      section->name, entry->version, (unsigned long long)entry->size);
+    return false;
+  }
+
+  if (entry->flags & SAVESTATE_FLAG_COMPRESSED) {
+    inflated = aligned_alloc(SAVESTATE_ALIGNMENT, internal_savestate_align(entry->size));
+    if (!inflated || !internal_savestate_decompress(image, entry->stored_size, inflated, entry->size)) {
+      LOGGER_ERROR("Failed to decompress save section %s\n", section->name);
+      free(inflated);
+      return false;
+    }
+    image = inflated;
+  }
+
+  bool ok = internal_savestate_hash(image, entry->size) == entry->hash;
+  if (!ok) {
+    LOGGER_ERROR("Save section %s is corrupted\n", section->name);
+  } else if (section->fixup) {
+    ok = section->fixup(section->data, section->size, image, entry->size, entry->version, section->user);
+  } else {
+    memcpy(section->data, image, section->size);
+  }
+
+  free(inflated);
+  return ok;
+}
+
+bool Savestate_Load(Savestate* saver) {
+  if (!saver) return false;
+  Savestate_Wait(saver);
+
+  Savestate_Mapping mappings[SAVESTATE_MAX_DELTAS + 1];
+  int mapping_count = 0;
+  char path[SAVESTATE_PATH_SIZE];
+
+  internal_savestate_path(saver, 0, false, path, sizeof(path));
+  if (!internal_savestate_map(path, &mappings[0]) || mappings[0].header->sequence != 0) {
+    if (mappings[0].base) munmap(mappings[0].base, mappings[0].size);
+    return false;
+  }
+  mapping_count = 1;
+
+  // A delta belongs to the chain only if it names the same snapshot and
+  // follows without a gap.
+  uint64_t chain_id = mappings[0].header->chain_id;
+  for (uint32_t sequence = 1; sequence <= SAVESTATE_MAX_DELTAS; sequence++) {
+    Savestate_Mapping* mapping = &mappings[mapping_count];
+    internal_savestate_path(saver, sequence, false, path, sizeof(path));
+    if (!internal_savestate_map(path, mapping)) break;
+    if (mapping->header->chain_id != chain_id || mapping->header->sequence != sequence) {
+      munmap(mapping->base, mapping->size);
+      break;
+    }
+    mapping_count++;
+  }
+
+  // Deltas past a gap are stale: the next save reuses the missing sequence,
+  // and a later Load would replay them on top of it.
+  for (uint32_t stale = (uint32_t)mapping_count; stale <= SAVESTATE_MAX_DELTAS; stale++) {
+    internal_savestate_path(saver, stale, false, path, sizeof(path));
+    unlink(path);
+  }
+
+  // Each section comes from the newest file holding it.
+  bool ok = true;
+  for (int i = 0; i < saver->section_count; i++) {
+    Savestate_Section* section = &saver->sections[i];
+    section->saved = false;
+
+    for (int m = mapping_count - 1; m >= 0; m--) {
+      const Savestate_SectionHeader* entry = internal_savestate_find(&mappings[m], section->id);
+      if (!entry) continue;
+
+      if (internal_savestate_apply(section, &mappings[m], entry)) {
+        // Matches what the next delta will hash only if applied verbatim.
+        section->saved = entry->size == section->size && entry->version == section->version;
+        section->saved_hash = entry->hash;
+      } else {
+        ok = false;
+      }
+      break;
+    }
+  }
+
+  saver->chain_id = chain_id;
+  saver->sequence = (uint32_t)mapping_count - 1;
+  saver->has_chain = true;
+
+  for (int m = 0; m < mapping_count; m++) munmap(mappings[m].base, mappings[m].size);
+  LOGGER_INFO("Loaded save %s with %d deltas\n", saver->prefix, mapping_count - 1);
+  return ok;
+}
+
+/* ---- Benchmark ---- */
+
+#define SAVESTATE_BENCH_SECTIONS 32
+#define SAVESTATE_BENCH_SECTION_SIZE (512 * 1024)
+#define SAVESTATE_BENCH_CHANGED 2
+#define SAVESTATE_BENCH_ROUNDS 4
+
+static double internal_savestate_bench_ms(uint64_t start) {
+  return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+static void internal_savestate_bench_fill(uint8_t* data, size_t size, uint32_t seed, bool compressible) {
+  uint32_t state = seed * 2654435761u + 1;
+  for (size_t i = 0; i < size; i += 4) {
+    state = state * 1664525u + 1013904223u;
+    // Structured state repeats with small variations, like arrays of entities.
+    uint32_t value = compressible ? (uint32_t)(i / 64) ^ (state >> 28) : state;
+    memcpy(data + i, &value, sizeof(value));
+  }
+}
+
+static off_t internal_savestate_bench_size(const Savestate* saver, uint32_t sequence) {
+  char path[SAVESTATE_PATH_SIZE];
+  struct stat info;
+  internal_savestate_path(saver, sequence, false, path, sizeof(path));
+  return stat(path, &info) == 0 ? info.st_size : 0;
+}
+
+void Savestate_Benchmark(void) {
+  const size_t total = (size_t)SAVESTATE_BENCH_SECTIONS * SAVESTATE_BENCH_SECTION_SIZE;
+  uint8_t* state = aligned_alloc(SAVESTATE_ALIGNMENT, total);
+  uint8_t* copy = malloc(total);
+  Savestate* saver = state && copy ? Savestate_Create("benchmark") : NULL;
+  if (!saver) {
+    LOGGER_ERROR("Failed to allocate savestate benchmark resources\n");
+    free(state);
+    free(copy);
+    return;
+  }
+
+  for (int i = 0; i < SAVESTATE_BENCH_SECTIONS; i++) {
+    char name[SAVESTATE_NAME_SIZE];
+    snprintf(name, sizeof(name), "bench%d", i);
+    internal_savestate_bench_fill(state + (size_t)i * SAVESTATE_BENCH_SECTION_SIZE, SAVESTATE_BENCH_SECTION_SIZE, (uint32_t)i, i % 4 != 0);
+    Savestate_AddSection(saver, (uint32_t)i + 1, name, 1, state + (size_t)i * SAVESTATE_BENCH_SECTION_SIZE,
+      SAVESTATE_BENCH_SECTION_SIZE, NULL, NULL);
+  }
+
+  LOGGER_INFO("Savestate benchmark: %d sections, %.1f MB of state\n", SAVESTATE_BENCH_SECTIONS, total / 1048576.0);
+
+  uint64_t start = SDL_GetPerformanceCounter();
+  Savestate_SaveFull(saver);
+  double capture_ms = internal_savestate_bench_ms(start);
+  bool ok = Savestate_Wait(saver);
+  double write_ms = internal_savestate_bench_ms(start);
+  off_t full_size = internal_savestate_bench_size(saver, 0);
+  LOGGER_INFO("Savestate full : capture %6.2f ms in frame, durable after %7.2f ms, %.1f MB on disk (%.0f%%)\n",
+    capture_ms, write_ms, full_size / 1048576.0, (double)full_size * 100.0 / total);
+
+  // Touch a couple of sections per round, as a few frames of play would.
+  for (int round = 1; ok && round <= SAVESTATE_BENCH_ROUNDS; round++) {
+    for (int c = 0; c < SAVESTATE_BENCH_CHANGED; c++) {
+      int section = (round * 7 + c * 5) % SAVESTATE_BENCH_SECTIONS;
+      internal_savestate_bench_fill(state + (size_t)section * SAVESTATE_BENCH_SECTION_SIZE,
+        SAVESTATE_BENCH_SECTION_SIZE, (uint32_t)(round * 1000 + c), true);
+    }
+
+    start = SDL_GetPerformanceCounter();
+    Savestate_Save(saver);
+    capture_ms = internal_savestate_bench_ms(start);
+    ok = Savestate_Wait(saver);
+    write_ms = internal_savestate_bench_ms(start);
+    off_t delta_size = internal_savestate_bench_size(saver, (uint32_t)round);
+    LOGGER_INFO("Savestate delta: capture %6.2f ms in frame, durable after %7.2f ms, %.1f KB on disk\n",
+      capture_ms, write_ms, delta_size / 1024.0);
+  }
+
+  memcpy(copy, state, total);
+  memset(state, 0, total);
+  start = SDL_GetPerformanceCounter();
+  bool loaded = Savestate_Load(saver);
+  double load_ms = internal_savestate_bench_ms(start);
+  bool match = memcmp(copy, state, total) == 0;
+  LOGGER_INFO("Savestate load : snapshot and %d deltas in %.2f ms (%.0f MB/s), %s\n", SAVESTATE_BENCH_ROUNDS,
+    load_ms, total / 1048576.0 / (load_ms / 1000.0), ok && loaded && match ? "verified" : "MISMATCH");
+
+  char path[SAVESTATE_PATH_SIZE];
+  for (uint32_t sequence = 0; sequence <= SAVESTATE_MAX_DELTAS; sequence++) {
+    internal_savestate_path(saver, sequence, false, path, sizeof(path));
+    unlink(path);
+  }
+
+  Savestate_Destroy(saver);
+  free(state);
+  free(copy);
+}
@@ -0,0 +1,519 @@
+#include <engine/spatial/spatial.h>
+#include <engine/logger.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+// Objects spanning more cells than this skip the grid and live in a short
+// list every query checks, so one huge box cannot flood the buckets.
+#define SPATIAL_MAX_OBJECT_CELLS 64
+#define SPATIAL_MIN_BUCKETS 1024
+
+typedef struct {
+  int* items;
+  int count;
+  int capacity;
+} Spatial_Bucket;
+
+typedef struct {
+  int x0, y0, x1, y1;
+} Spatial_CellRange;
+
+typedef struct {
+  SDL_FRect bounds;
+  Spatial_CellRange cells;
+  void* user_data;
+  uint32_t stamp;
+  bool alive;
+  bool oversized;
+} Spatial_Object;
+
+struct Spatial_Index {
+  float cell_size;
+  float inv_cell_size;
+
+  Spatial_Bucket* buckets;
+  uint32_t bucket_mask;
+
+  Spatial_Bucket oversized;
+
+  Spatial_Object* objects;
+  int object_count; // High-water mark of used ids
+  int object_capacity;
+  int live_count;
+
+  Spatial_Bucket free_ids;
+
+  uint32_t stamp;
+};
+
+static bool internal_spatial_bucket_push(Spatial_Bucket* bucket, int value) {
+  if (bucket->count == bucket->capacity) {
+    int capacity = bucket->capacity ? bucket->capacity * 2 : 4;
+    int* items = realloc(bucket->items, (size_t)capacity * sizeof(int));
+    if (!items) {
+      LOGGER_ERROR("Failed to grow spatial bucket\n");
+      return false;
+    }
+    bucket->items = items;
+    bucket->capacity = capacity;
+  }
+
+  bucket->items[bucket->count++] = value;
+  return true;
+}
+
+static void internal_spatial_bucket_remove(Spatial_Bucket* bucket, int value) {
+  for (int i = 0; i < bucket->count; i++) {
+    if (bucket->items[i] == value) {
+      bucket->items[i] = bucket->items[--bucket->count];
+      return;
+    }
+  }
+}
+
+static inline Spatial_Bucket* internal_spatial_bucket(Spatial_Index* index, int cx, int cy) {
+  uint32_t hash = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+  return &index->buckets[hash & index->bucket_mask];
+}
+
+static inline Spatial_CellRange internal_spatial_cells(const Spatial_Index* index, SDL_FRect bounds) {
+  return (Spatial_CellRange){
+    (int)floorf(bounds.x * index->inv_cell_size),
+    (int)floorf(bounds.y * index->inv_cell_size),
+    (int)floorf((bounds.x + bounds.w) * index->inv_cell_size),
+    (int)floorf((bounds.y + bounds.h) * index->inv_cell_size)
+  };
+}
+
+static inline int64_t internal_spatial_cell_count(Spatial_CellRange r) {
+  return (int64_t)(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1);
+}
+
+static inline bool internal_spatial_overlaps(const SDL_FRect* a, const SDL_FRect* b) {
+  return a->x <= b->x + b->w && b->x <= a->x + a->w
+      && a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+static inline bool internal_spatial_overlaps_circle(const SDL_FRect* box, SDL_FPoint center, float radius) {
+  float nx = center.x < box->x ? box->x : (center.x > box->x + box->w ? box->x + box->w : center.x);
+  float ny = center.y < box->y ? box->y : (center.y > box->y + box->h ? box->y + box->h : center.y);
+  float dx = center.x - nx, dy = center.y - ny;
+  return dx * dx + dy * dy <= radius * radius;
+}
+
+// Query stamps mark objects already visited so overlapping cells and hash
+// collisions never report an object twice.
+static uint32_t internal_spatial_next_stamp(Spatial_Index* index) {
+  if (++index->stamp == 0) {
+    for (int i = 0; i < index->object_count; i++) index->objects[i].stamp = 0;
+    index->stamp = 1;
+  }
+  return index->stamp;
+}
+
+static void internal_spatial_link(Spatial_Index* index, int id) {
+  Spatial_Object* object = &index->objects[id];
+  object->oversized = internal_spatial_cell_count(object->cells) > SPATIAL_MAX_OBJECT_CELLS;
+
+  if (object->oversized) {
+    internal_spatial_bucket_push(&index->oversized, id);
+    return;
+  }
+
+  for (int cy = object->cells.y0; cy <= object->cells.y1; cy++) {
+    for (int cx = object->cells.x0; cx <= object->cells.x1; cx++) {
+      internal_spatial_bucket_push(internal_spatial_bucket(index, cx, cy), id);
+    }
+  }
+}
+
+static void internal_spatial_unlink(Spatial_Index* index, int id) {
+  Spatial_Object* object = &index->objects[id];
+
+  if (object->oversized) {
+    internal_spatial_bucket_remove(&index->oversized, id);
+    return;
+  }
+
+  for (int cy = object->cells.y0; cy <= object->cells.y1; cy++) {
+    for (int cx = object->cells.x0; cx <= object->cells.x1; cx++) {
+      internal_spatial_bucket_remove(internal_spatial_bucket(index, cx, cy), id);
+    }
+  }
+}
+
+Spatial_Index* Spatial_Create(float cell_size, int expected_objects) {
+  if (cell_size <= 0.0f) {
+    LOGGER_ERROR("Spatial_Create: cell size must be positive\n");
+    return NULL;
+  }
+
+  Spatial_Index* index = calloc(1, sizeof(Spatial_Index));
+  if (!index) return NULL;
+
+  uint32_t bucket_count = SPATIAL_MIN_BUCKETS;
+  while (bucket_count < (uint32_t)expected_objects * 2 && bucket_count < (1u << 24)) bucket_count <<= 1;
+
+  index->buckets = calloc(bucket_count, sizeof(Spatial_Bucket));
+  if (!index->buckets) {
+    free(index);
+    return NULL;
+  }
+
+  index->bucket_mask = bucket_count - 1;
+  index->cell_size = cell_size;
+  index->inv_cell_size = 1.0f / cell_size;
+
+  return index;
+}
+
+void Spatial_Destroy(Spatial_Index* index) {
+  if (!index) return;
+
+  for (uint32_t i = 0; i <= index->bucket_mask; i++) free(index->buckets[i].items);
+  free(index->buckets);
+  free(index->oversized.items);
+  free(index->free_ids.items);
+  free(index->objects);
+  free(index);
+}
+
+int Spatial_Insert(Spatial_Index* index, SDL_FRect bounds, void* user_data) {
+  if (!index) return -1;
+
+  int id;
+  if (index->free_ids.count > 0) {
+    id = index->free_ids.items[--index->free_ids.count];
+  } else {
+    if (index->object_count == index->object_capacity) {
+      int capacity = index->object_capacity ? index->object_capacity * 2 : 256;
+      Spatial_Object* objects = realloc(index->objects, (size_t)capacity * sizeof(Spatial_Object));
+      if (!objects) {
+        LOGGER_ERROR("Failed to grow spatial object table\n");
+        return -1;
+      }
+      index->objects = objects;
+      index->object_capacity = capacity;
+    }
+    id = index->object_count++;
+  }
+
+  index->objects[id] = (Spatial_Object){
+    .bounds = bounds,
+    .cells = internal_spatial_cells(index, bounds),
+    .user_data = user_data,
+    .alive = true
+  };
+  internal_spatial_link(index, id);
+  index->live_count++;
+
+  return id;
+}
+
+void Spatial_Remove(Spatial_Index* index, int id) {
+  if (!index || id < 0 || id >= index->object_count || !index->objects[id].alive) return;
+
+  internal_spatial_unlink(index, id);
+  index->objects[id].alive = false;
+  internal_spatial_bucket_push(&index->free_ids, id);
+  index->live_count--;
+}
+
+void Spatial_Move(Spatial_Index* index, int id, SDL_FRect bounds) {
+  if (!index || id < 0 || id >= index->object_count || !index->objects[id].alive) return;
+
+  Spatial_Object* object = &index->objects[id];
+  Spatial_CellRange cells = internal_spatial_cells(index, bounds);
+  object->bounds = bounds;
+
+  // Most frames an object stays inside the same cells: nothing to relink.
+  if (memcmp(&cells, &object->cells, sizeof(cells)) == 0) return;
+
+  internal_spatial_unlink(index, id);
+  object->cells = cells;
+  internal_spatial_link(index, id);
+}
+
+void* Spatial_GetUserData(const Spatial_Index* index, int id) {
+  if (!index || id < 0 || id >= index->object_count || !index->objects[id].alive) return NULL;
+  return index->objects[id].user_data;
+}
+
+int Spatial_GetCount(const Spatial_Index* index) {
+  return index ? index->live_count : 0;
+}
+
+
+/* ---- Queries ---- */
+
+static bool internal_spatial_results_push(Spatial_Results* results, int id) {
+  if (results->count == results->capacity) {
+    int capacity = results->capacity ? results->capacity * 2 : 256;
+    int* ids = realloc(results->ids, (size_t)capacity * sizeof(int));
+    if (!ids) {
+      LOGGER_ERROR("Failed to grow spatial query results\n");
+      return false;
+    }
+    results->ids = ids;
+    results->capacity = capacity;
+  }
+
+  results->ids[results->count++] = id;
+  return true;
+}
+
+static bool internal_spatial_results_begin(Spatial_Results* results, int query_count) {
+  if (query_count + 1 > results->offsets_capacity) {
+    int* offsets = realloc(results->offsets, (size_t)(query_count + 1) * sizeof(int));
+    if (!offsets) {
+      LOGGER_ERROR("Failed to grow spatial query offsets\n");
+      return false;
+    }
+    results->offsets = offsets;
+    results->offsets_capacity = query_count + 1;
+  }
+
+  results->count = 0;
+  results->query_count = 0;
+  results->offsets[0] = 0;
+  return true;
+}
+
+static inline void internal_spatial_results_end_query(Spatial_Results* results) {
+  results->offsets[++results->query_count] = results->count;
+}
+
+typedef struct {
+  bool is_circle;
+  SDL_FRect box; // The region, or the circle's bounding box
+  SDL_FPoint center;
+  float radius;
+} Spatial_Shape;
+
+static inline bool internal_spatial_shape_hits(const Spatial_Shape* shape, const SDL_FRect* bounds) {
+  if (!internal_spatial_overlaps(&shape->box, bounds)) return false;
+  return !shape->is_circle || internal_spatial_overlaps_circle(bounds, shape->center, shape->radius);
+}
+
+static void internal_spatial_visit(Spatial_Index* index, uint32_t stamp, const Spatial_Shape* shape, const Spatial_Bucket* bucket, Spatial_Results* results) {
+  for (int i = 0; i < bucket->count; i++) {
+    Spatial_Object* object = &index->objects[bucket->items[i]];
+    if (object->stamp == stamp) continue;
+
+    object->stamp = stamp;
+    if (internal_spatial_shape_hits(shape, &object->bounds)) internal_spatial_results_push(results, bucket->items[i]);
+  }
+}
+
+static void internal_spatial_query_shape(Spatial_Index* index, const Spatial_Shape* shape, Spatial_Results* results) {
+  uint32_t stamp = internal_spatial_next_stamp(index);
+  Spatial_CellRange cells = internal_spatial_cells(index, shape->box);
+
+  internal_spatial_visit(index, stamp, shape, &index->oversized, results);
+
+  // A query wider than the table itself is cheaper as one pass over every bucket.
+  if (internal_spatial_cell_count(cells) > (int64_t)index->bucket_mask + 1) {
+    for (uint32_t i = 0; i <= index->bucket_mask; i++) {
+      internal_spatial_visit(index, stamp, shape, &index->buckets[i], results);
+    }
+    return;
+  }
+
+  for (int cy = cells.y0; cy <= cells.y1; cy++) {
+    for (int cx = cells.x0; cx <= cells.x1; cx++) {
+      internal_spatial_visit(index, stamp, shape, internal_spatial_bucket(index, cx, cy), results);
+    }
+  }
+}
+
+void Spatial_QueryRegions(Spatial_Index* index, const SDL_FRect* regions, int count, Spatial_Results* results) {
+  if (!index || !results || !internal_spatial_results_begin(results, count)) return;
+
+  for (int q = 0; q < count; q++) {
+    Spatial_Shape shape = { .is_circle = false, .box = regions[q] };
+    internal_spatial_query_shape(index, &shape, results);
+    internal_spatial_results_end_query(results);
+  }
+}
+
+void Spatial_QueryRadii(Spatial_Index* index, const SDL_FPoint* centers, const float* radii, int count, Spatial_Results* results) {
+  if (!index || !results || !internal_spatial_results_begin(results, count)) return;
+
+  for (int q = 0; q < count; q++) {
+    Spatial_Shape shape = {
+      .is_circle = true,
+      .box = { centers[q].x - radii[q], centers[q].y - radii[q], radii[q] * 2.0f, radii[q] * 2.0f },
+      .center = centers[q],
+      .radius = radii[q]
+    };
+    internal_spatial_query_shape(index, &shape, results);
+    internal_spatial_results_end_query(results);
+  }
+}
+
+// Every overlapping pair once, as (lower id, higher id).
+void Spatial_QueryPairs(Spatial_Index* index, Spatial_Results* results) {
+  if (!index || !results || !internal_spatial_results_begin(results, 1)) return;
+
+  for (int a = 0; a < index->object_count; a++) {
+    Spatial_Object* object = &index->objects[a];
+    if (!object->alive) continue;
+
+    // Oversized objects are not in the grid, so they test everything else
+    // themselves; among each other only the lower id reports.
+    if (object->oversized) {
+      for (int b = 0; b < index->object_count; b++) {
+        const Spatial_Object* other = &index->objects[b];
+        if (b == a || !other->alive || (other->oversized && b < a)) continue;
+        if (!internal_spatial_overlaps(&object->bounds, &other->bounds)) continue;
+
+        internal_spatial_results_push(results, a < b ? a : b);
+        internal_spatial_results_push(results, a < b ? b : a);
+      }
+      continue;
+    }
+
+    uint32_t stamp = internal_spatial_next_stamp(index);
+    for (int cy = object->cells.y0; cy <= object->cells.y1; cy++) {
+      for (int cx = object->cells.x0; cx <= object->cells.x1; cx++) {
+        const Spatial_Bucket* bucket = internal_spatial_bucket(index, cx, cy);
+
+        for (int i = 0; i < bucket->count; i++) {
+          int b = bucket->items[i];
+          Spatial_Object* other = &index->objects[b];
+          if (b <= a || other->stamp == stamp) continue;
+
+          other->stamp = stamp;
+          if (internal_spatial_overlaps(&object->bounds, &other->bounds)) {
+            internal_spatial_results_push(results, a);
+            internal_spatial_results_push(results, b);
+          }
+        }
+      }
+    }
+  }
+
+  internal_spatial_results_end_query(results);
+}
+
+void Spatial_FreeResults(Spatial_Results* results) {
+  if (!results) return;
+
+  free(results->ids);
+  free(results->offsets);
+  *results = (Spatial_Results){0};
+}
+
+
+/* ---- Benchmark ---- */
+
+#define SPATIAL_BENCH_OBJECTS 100000
+#define SPATIAL_BENCH_WORLD 8192.0f
+#define SPATIAL_BENCH_CELL 64.0f
+#define SPATIAL_BENCH_FRAMES 60
+#define SPATIAL_BENCH_QUERIES 10000
+
+typedef struct {
+  SDL_FRect bounds;
+  float vx, vy;
+} Spatial_BenchObject;
+
+static float internal_spatial_bench_random(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return (float)(*state >> 8) / 16777216.0f;
+}
+
+static double internal_spatial_bench_ms(uint64_t start) {
+  return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+static void internal_spatial_bench_run(Spatial_Index* index, Spatial_BenchObject* objects, SDL_FRect* regions, SDL_FPoint* centers, float* radii, Spatial_Results* results) {
+  uint32_t seed = 0xC0FFEEu;
+  uint64_t start = SDL_GetPerformanceCounter();
+  for (int i = 0; i < SPATIAL_BENCH_OBJECTS; i++) {
+    float size = 8.0f + internal_spatial_bench_random(&seed) * 24.0f;
+    objects[i].bounds = (SDL_FRect){
+      internal_spatial_bench_random(&seed) * (SPATIAL_BENCH_WORLD - size),
+      internal_spatial_bench_random(&seed) * (SPATIAL_BENCH_WORLD - size),
+      size, size
+    };
+    objects[i].vx = (internal_spatial_bench_random(&seed) - 0.5f) * 8.0f;
+    objects[i].vy = (internal_spatial_bench_random(&seed) - 0.5f) * 8.0f;
+    Spatial_Insert(index, objects[i].bounds, &objects[i]);
+  }
+  double insert_ms = internal_spatial_bench_ms(start);
+
+  start = SDL_GetPerformanceCounter();
+  for (int frame = 0; frame < SPATIAL_BENCH_FRAMES; frame++) {
+    for (int i = 0; i < SPATIAL_BENCH_OBJECTS; i++) {
+      Spatial_BenchObject* o = &objects[i];
+      o->bounds.x += o->vx;
+      o->bounds.y += o->vy;
+      if (o->bounds.x < 0.0f || o->bounds.x + o->bounds.w > SPATIAL_BENCH_WORLD) o->vx = -o->vx;
+      if (o->bounds.y < 0.0f || o->bounds.y + o->bounds.h > SPATIAL_BENCH_WORLD) o->vy = -o->vy;
+      Spatial_Move(index, i, o->bounds);
+    }
+  }
+  double update_ms = internal_spatial_bench_ms(start) / SPATIAL_BENCH_FRAMES;
+
+  for (int q = 0; q < SPATIAL_BENCH_QUERIES; q++) {
+    regions[q] = (SDL_FRect){
+      internal_spatial_bench_random(&seed) * (SPATIAL_BENCH_WORLD - 256.0f),
+      internal_spatial_bench_random(&seed) * (SPATIAL_BENCH_WORLD - 256.0f),
+      256.0f, 256.0f
+    };
+    centers[q] = (SDL_FPoint){ regions[q].x + 128.0f, regions[q].y + 128.0f };
+    radii[q] = 128.0f;
+  }
+
+  start = SDL_GetPerformanceCounter();
+  Spatial_QueryRegions(index, regions, SPATIAL_BENCH_QUERIES, results);
+  double region_ms = internal_spatial_bench_ms(start);
+  int region_hits = results->count;
+
+  start = SDL_GetPerformanceCounter();
+  Spatial_QueryRadii(index, centers, radii, SPATIAL_BENCH_QUERIES, results);
+  double radius_ms = internal_spatial_bench_ms(start);
+  int radius_hits = results->count;
+
+  start = SDL_GetPerformanceCounter();
+  Spatial_QueryPairs(index, results);
+  double pairs_ms = internal_spatial_bench_ms(start);
+
+  LOGGER_INFO("Spatial benchmark: %d moving objects, %.0f world units, cell %.0f\n",
+    SPATIAL_BENCH_OBJECTS, SPATIAL_BENCH_WORLD, SPATIAL_BENCH_CELL);
+  LOGGER_INFO("Spatial insert : %.3f ms total\n", insert_ms);
+  LOGGER_INFO("Spatial update : %.3f ms/frame (%.1f ns/object)\n",
+    update_ms, update_ms * 1.0e6 / SPATIAL_BENCH_OBJECTS);
+  LOGGER_INFO("Spatial regions: %10.0f queries/s (%d hits)\n", SPATIAL_BENCH_QUERIES * 1000.0 / region_ms, region_hits);
+  LOGGER_INFO("Spatial radii  : %10.0f queries/s (%d hits)\n", SPATIAL_BENCH_QUERIES * 1000.0 / radius_ms, radius_hits);
+  LOGGER_INFO("Spatial pairs  : %.3f ms (%d overlapping pairs)\n", pairs_ms, results->count / 2);
+}
+
+void Spatial_Benchmark(void) {
+  Spatial_Index* index = Spatial_Create(SPATIAL_BENCH_CELL, SPATIAL_BENCH_OBJECTS);
+  Spatial_BenchObject* objects = malloc(SPATIAL_BENCH_OBJECTS * sizeof(Spatial_BenchObject));
+  SDL_FRect* regions = malloc(SPATIAL_BENCH_QUERIES * sizeof(SDL_FRect));
+  SDL_FPoint* centers = malloc(SPATIAL_BENCH_QUERIES * sizeof(SDL_FPoint));
+  float* radii = malloc(SPATIAL_BENCH_QUERIES * sizeof(float));
+  Spatial_Results results = {0};
+
+  if (index && objects && regions && centers && radii) {
+    internal_spatial_bench_run(index, objects, regions, centers, radii, &results);
+  } else {
+    LOGGER_ERROR("Failed to allocate spatial benchmark resources\n");
+  }
+
+  Spatial_FreeResults(&results);
+  free(radii);
+  free(centers);
+  free(regions);
+  free(objects);
+  Spatial_Destroy(index);
+}
@@ -0,0 +1,429 @@
+#include <engine/tilemap/tilemap.h>
+#include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+#define TILEMAP_CHUNK_TILES 32
+#define TILEMAP_DEFAULT_CACHE_BYTES (64u * 1024u * 1024u)
+#define TILEMAP_NO_CHUNK -1
+
+typedef struct {
+  SDL_Texture* texture;
+  bool dirty;
+  int filled_tiles; // Chunks with no tiles are never given a texture
+  uint64_t last_frame;
+  int lru_prev;
+  int lru_next;
+} Tilemap_Chunk;
+
+struct Tilemap {
+  int width;
+  int height;
+  int tile_size;
+  uint16_t* tiles;
+
+  SDL_Texture* tileset;
+  int tileset_columns;
+
+  Tilemap_Chunk* chunks;
+  int chunks_x;
+  int chunks_y;
+  size_t chunk_bytes;
+
+  // Cached chunks, most recently drawn at the head.
+  int lru_head;
+  int lru_tail;
+  size_t cache_bytes;
+  size_t cache_limit;
+
+  uint64_t frame;
+  Tilemap_FrameStats stats;
+
+  Metrics_Gauge* cache_metric;
+  Metrics_Counter* rebuilt_metric;
+  Metrics_Counter* evicted_metric;
+};
+
+Tilemap* Tilemap_Create(SDL_Renderer* renderer, int width, int height, int tile_size, SDL_Texture* tileset, int tileset_columns) {
+  if (width <= 0 || height <= 0 || tile_size <= 0 || tileset_columns <= 0) {
+    LOGGER_ERROR("Tilemap_Create: invalid dimensions\n");
+    return NULL;
+  }
+  // Every chunk is a render target; without them nothing could be cached.
+  if (!renderer || !SDL_RenderTargetSupported(renderer)) {
+    LOGGER_ERROR("Tilemap_Create: renderer does not support render targets\n");
+    return NULL;
+  }
+
+  Tilemap* map = calloc(1, sizeof(Tilemap));
+  if (!map) return NULL;
+
+  map->width = width;
+  map->height = height;
+  map->tile_size = tile_size;
+  map->tileset = tileset;
+  map->tileset_columns = tileset_columns;
+  map->chunks_x = (width + TILEMAP_CHUNK_TILES - 1) / TILEMAP_CHUNK_TILES;
+  map->chunks_y = (height + TILEMAP_CHUNK_TILES - 1) / TILEMAP_CHUNK_TILES;
+  map->chunk_bytes = (size_t)TILEMAP_CHUNK_TILES * tile_size * TILEMAP_CHUNK_TILES * tile_size * 4;
+  map->lru_head = TILEMAP_NO_CHUNK;
+  map->lru_tail = TILEMAP_NO_CHUNK;
+  map->cache_limit = TILEMAP_DEFAULT_CACHE_BYTES;
+  map->cache_metric = Metrics_RegisterGauge("memory_tilemap_cache_bytes");
+  map->rebuilt_metric = Metrics_RegisterCounter("tilemap_chunks_rebuilt_total");
+  map->evicted_metric = Metrics_RegisterCounter("tilemap_chunks_evicted_total");
+
+  map->tiles = calloc((size_t)width * height, sizeof(uint16_t));
+  map->chunks = calloc((size_t)map->chunks_x * map->chunks_y, sizeof(Tilemap_Chunk));
+  if (!map->tiles || !map->chunks) {
+    LOGGER_ERROR("Failed to allocate tilemap of %dx%d tiles\n", width, height);
+    Tilemap_Destroy(map);
+    return NULL;
+  }
+
+  for (int i = 0; i < map->chunks_x * map->chunks_y; i++) {
+    map->chunks[i].lru_prev = TILEMAP_NO_CHUNK;
+    map->chunks[i].lru_next = TILEMAP_NO_CHUNK;
+  }
+
+  return map;
+}
+
+void Tilemap_Destroy(Tilemap* map) {
+  if (!map) return;
+
+  if (map->chunks) {
+    for (int i = 0; i < map->chunks_x * map->chunks_y; i++) {
+      if (map->chunks[i].texture) SDL_DestroyTexture(map->chunks[i].texture);
+    }
+  }
+  Metrics_GaugeAdd(map->cache_metric, -(int64_t)map->cache_bytes);
+
+  free(map->chunks);
+  free(map->tiles);
+  free(map);
+}
+
+void Tilemap_SetCacheLimit(Tilemap* map, size_t bytes) {
+  if (map) map->cache_limit = bytes;
+}
+
+void Tilemap_SetTile(Tilemap* map, int x, int y, uint16_t tile) {
+  if (!map || x < 0 || y < 0 || x >= map->width || y >= map->height) return;
+
+  uint16_t* cell = &map->tiles[(size_t)y * map->width + x];
+  if (*cell == tile) return;
+
+  Tilemap_Chunk* chunk = &map->chunks[(y / TILEMAP_CHUNK_TILES) * map->chunks_x + x / TILEMAP_CHUNK_TILES];
+  if (*cell == TILEMAP_EMPTY_TILE) chunk->filled_tiles++;
+  if (tile == TILEMAP_EMPTY_TILE) chunk->filled_tiles--;
+
+  *cell = tile;
+  chunk->dirty = true;
+}
+
+uint16_t Tilemap_GetTile(const Tilemap* map, int x, int y) {
+  if (!map || x < 0 || y < 0 || x >= map->width || y >= map->height) return TILEMAP_EMPTY_TILE;
+  return map->tiles[(size_t)y * map->width + x];
+}
+
+void Tilemap_InvalidateAll(Tilemap* map) {
+  if (!map) return;
+
+  for (int i = 0; i < map->chunks_x * map->chunks_y; i++) map->chunks[i].dirty = true;
+}
+
+Tilemap_FrameStats Tilemap_GetFrameStats(const Tilemap* map) {
+  return map ? map->stats : (Tilemap_FrameStats){0};
+}
+
+
+/* ---- Chunk cache ---- */
+
+static void internal_tilemap_lru_unlink(Tilemap* map, int index) {
+  Tilemap_Chunk* chunk = &map->chunks[index];
+
+  if (chunk->lru_prev != TILEMAP_NO_CHUNK) map->chunks[chunk->lru_prev].lru_next = chunk->lru_next;
+  else map->lru_head = chunk->lru_next;
+
+  if (chunk->lru_next != TILEMAP_NO_CHUNK) map->chunks[chunk->lru_next].lru_prev = chunk->lru_prev;
+  else map->lru_tail = chunk->lru_prev;
+
+  chunk->lru_prev = TILEMAP_NO_CHUNK;
+  chunk->lru_next = TILEMAP_NO_CHUNK;
+}
+
+static void internal_tilemap_lru_push_head(Tilemap* map, int index) {
+  Tilemap_Chunk* chunk = &map->chunks[index];
+
+  chunk->lru_prev = TILEMAP_NO_CHUNK;
+  chunk->lru_next = map->lru_head;
+  if (map->lru_head != TILEMAP_NO_CHUNK) map->chunks[map->lru_head].lru_prev = index;
+  map->lru_head = index;
+  if (map->lru_tail == TILEMAP_NO_CHUNK) map->lru_tail = index;
+}
+
+static void internal_tilemap_evict(Tilemap* map, int index) {
+  Tilemap_Chunk* chunk = &map->chunks[index];
+
+  internal_tilemap_lru_unlink(map, index);
+  SDL_DestroyTexture(chunk->texture);
+  chunk->texture = NULL;
+  map->cache_bytes -= map->chunk_bytes;
+  map->stats.chunks_evicted++;
+  Metrics_GaugeAdd(map->cache_metric, -(int64_t)map->chunk_bytes);
+  Metrics_CounterAdd(map->evicted_metric, 1);
+}
+
+// Evicts from the cold end until extra_bytes more fit. Chunks already drawn
+// this frame are never evicted, so a view larger than the limit overshoots
+// until the camera moves on.
+static void internal_tilemap_make_room(Tilemap* map, size_t extra_bytes) {
+  while (map->cache_bytes + extra_bytes > map->cache_limit && map->lru_tail != TILEMAP_NO_CHUNK) {
+    if (map->chunks[map->lru_tail].last_frame == map->frame) break;
+    internal_tilemap_evict(map, map->lru_tail);
+  }
+}
+
+void Tilemap_OnDeviceReset(Tilemap* map) {
+  if (!map) return;
+
+  // The dead handles still own their SDL bookkeeping, so release them all.
+  while (map->lru_tail != TILEMAP_NO_CHUNK) internal_tilemap_evict(map, map->lru_tail);
+}
+
+void Tilemap_SetTileset(Tilemap* map, SDL_Texture* tileset, int tileset_columns) {
+  if (!map || tileset_columns <= 0) return;
+
+  map->tileset = tileset;
+  map->tileset_columns = tileset_columns;
+  Tilemap_InvalidateAll(map);
+}
+
+static bool internal_tilemap_acquire(Tilemap* map, SDL_Renderer* renderer, int index) {
+  Tilemap_Chunk* chunk = &map->chunks[index];
+
+  if (chunk->texture) {
+    internal_tilemap_lru_unlink(map, index);
+    internal_tilemap_lru_push_head(map, index);
+    return true;
+  }
+
+  internal_tilemap_make_room(map, map->chunk_bytes);
+
+  int pixels = TILEMAP_CHUNK_TILES * map->tile_size;
+  chunk->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, pixels, pixels);
+  if (!chunk->texture) {
+    LOGGER_ERROR("Failed to create tilemap chunk texture: %s\n", SDL_GetError());
+    return false;
+  }
+  SDL_SetTextureBlendMode(chunk->texture, SDL_BLENDMODE_BLEND);
+
+  chunk->dirty = true;
+  map->cache_bytes += map->chunk_bytes;
+  Metrics_GaugeAdd(map->cache_metric, (int64_t)map->chunk_bytes);
+  internal_tilemap_lru_push_head(map, index);
+  return true;
+}
+
+static void internal_tilemap_rebuild(Tilemap* map, SDL_Renderer* renderer, int index) {
+  Tilemap_Chunk* chunk = &map->chunks[index];
+  int first_x = (index % map->chunks_x) * TILEMAP_CHUNK_TILES;
+  int first_y = (index / map->chunks_x) * TILEMAP_CHUNK_TILES;
+  int ts = map->tile_size;
+
+  SDL_SetRenderTarget(renderer, chunk->texture);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
+
+  for (int y = 0; y < TILEMAP_CHUNK_TILES && first_y + y < map->height; y++) {
+    const uint16_t* row = &map->tiles[(size_t)(first_y + y) * map->width + first_x];
+
+    for (int x = 0; x < TILEMAP_CHUNK_TILES && first_x + x < map->width; x++) {
+      if (row[x] == TILEMAP_EMPTY_TILE) continue;
+
+      int tile = row[x] - 1;
+      SDL_Rect src = { (tile % map->tileset_columns) * ts, (tile / map->tileset_columns) * ts, ts, ts };
+      SDL_Rect dst = { x * ts, y * ts, ts, ts };
+      SDL_RenderCopy(renderer, map->tileset, &src, &dst);
+    }
+  }
+
+  chunk->dirty = false;
+  map->stats.chunks_rebuilt++;
+  Metrics_CounterAdd(map->rebuilt_metric, 1);
+}
+
+// Rounds towards negative infinity, so cameras left of or above the map
+// land on negative chunks instead of chunk 0.
+static inline int internal_tilemap_floor_div(int value, int divisor) {
+  int quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+void Tilemap_Draw(Tilemap* map, SDL_Renderer* renderer, const SDL_Rect* camera) {
+  if (!map || !renderer || !camera) return;
+
+  map->frame++;
+  map->stats = (Tilemap_FrameStats){0};
+
+  int chunk_pixels = TILEMAP_CHUNK_TILES * map->tile_size;
+  int cx0 = internal_tilemap_floor_div(camera->x, chunk_pixels);
+  int cy0 = internal_tilemap_floor_div(camera->y, chunk_pixels);
+  int cx1 = internal_tilemap_floor_div(camera->x + camera->w - 1, chunk_pixels);
+  int cy1 = internal_tilemap_floor_div(camera->y + camera->h - 1, chunk_pixels);
+  if (cx0 < 0) cx0 = 0;
+  if (cy0 < 0) cy0 = 0;
+  if (cx1 >= map->chunks_x) cx1 = map->chunks_x - 1;
+  if (cy1 >= map->chunks_y) cy1 = map->chunks_y - 1;
+  if (cx1 < cx0 || cy1 < cy0) return; // The camera misses the map entirely
+
+  SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+
+  // Rebuild every stale chunk first so the render target only switches
+  // back once, then blit the cached textures in one run.
+  for (int cy = cy0; cy <= cy1; cy++) {
+    for (int cx = cx0; cx <= cx1; cx++) {
+      int index = cy * map->chunks_x + cx;
+      Tilemap_Chunk* chunk = &map->chunks[index];
+      if (chunk->filled_tiles == 0) continue;
+
+      if (!internal_tilemap_acquire(map, renderer, index)) continue;
+      chunk->last_frame = map->frame;
+      if (chunk->dirty) internal_tilemap_rebuild(map, renderer, index);
+    }
+  }
+
+  if (map->stats.chunks_rebuilt > 0) SDL_SetRenderTarget(renderer, previous_target);
+
+  for (int cy = cy0; cy <= cy1; cy++) {
+    for (int cx = cx0; cx <= cx1; cx++) {
+      Tilemap_Chunk* chunk = &map->chunks[cy * map->chunks_x + cx];
+      if (!chunk->texture || chunk->last_frame != map->frame) continue;
+
+      SDL_Rect dst = { cx * chunk_pixels - camera->x, cy * chunk_pixels - camera->y, chunk_pixels, chunk_pixels };
+      SDL_RenderCopy(renderer, chunk->texture, NULL, &dst);
+      map->stats.chunks_drawn++;
+    }
+  }
+
+  internal_tilemap_make_room(map, 0);
+
+  map->stats.cache_bytes = map->cache_bytes;
+  map->stats.chunks_cached = (int)(map->cache_bytes / map->chunk_bytes);
+}
+
+/* ---- Benchmark ---- */
+
+#define TILEMAP_BENCH_WIDTH 1280
+#define TILEMAP_BENCH_HEIGHT 720
+#define TILEMAP_BENCH_MAP_TILES 512
+#define TILEMAP_BENCH_TILE_SIZE 16
+#define TILEMAP_BENCH_TILESET_COLUMNS 8
+#define TILEMAP_BENCH_FRAMES 240
+#define TILEMAP_BENCH_REPORT_EVERY 30
+#define TILEMAP_BENCH_EDITS 4 // Tiles changed in view every frame, like animated tiles
+#define TILEMAP_BENCH_CACHE_CHUNKS 12
+
+static SDL_Texture* internal_tilemap_bench_tileset(SDL_Renderer* renderer) {
+  int ts = TILEMAP_BENCH_TILE_SIZE;
+  int side = TILEMAP_BENCH_TILESET_COLUMNS * ts;
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, side, side, 32, SDL_PIXELFORMAT_ARGB8888);
+  if (!surface) return NULL;
+
+  // Every tile a flat colour picked by its cell, with a dark border.
+  for (int y = 0; y < side; y++) {
+    uint32_t* row = (uint32_t*)((uint8_t*)surface->pixels + (size_t)y * surface->pitch);
+    for (int x = 0; x < side; x++) {
+      bool border = x % ts == 0 || y % ts == 0;
+      row[x] = border ? 0xff202020u : 0xff0000a0u | (uint32_t)(x / ts * 32) << 16 | (uint32_t)(y / ts * 32) << 8;
+    }
+  }
+
+  SDL_Texture* tileset = SDL_CreateTextureFromSurface(renderer, surface);
+  SDL_FreeSurface(surface);
+  return tileset;
+}
+
+void Tilemap_Benchmark(void) {
+  SDL_Surface* fb = SDL_CreateRGBSurfaceWithFormat(0, TILEMAP_BENCH_WIDTH, TILEMAP_BENCH_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+  SDL_Renderer* renderer = fb ? SDL_CreateSoftwareRenderer(fb) : NULL;
+  SDL_Texture* tileset = renderer ? internal_tilemap_bench_tileset(renderer) : NULL;
+  Tilemap* map = tileset ? Tilemap_Create(renderer, TILEMAP_BENCH_MAP_TILES, TILEMAP_BENCH_MAP_TILES,
+    TILEMAP_BENCH_TILE_SIZE, tileset, TILEMAP_BENCH_TILESET_COLUMNS) : NULL;
+
+  if (!map) {
+    LOGGER_ERROR("Failed to create tilemap benchmark resources: %s\n", SDL_GetError());
+    if (tileset) SDL_DestroyTexture(tileset);
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (fb) SDL_FreeSurface(fb);
+    return;
+  }
+
+  // Deterministic fill with a fifth of the cells empty, so some chunks stay
+  // sparse and a few stay empty.
+  int tile_count = TILEMAP_BENCH_TILESET_COLUMNS * TILEMAP_BENCH_TILESET_COLUMNS;
+  uint32_t seed = 0x12345678u;
+  for (int y = 0; y < TILEMAP_BENCH_MAP_TILES; y++) {
+    for (int x = 0; x < TILEMAP_BENCH_MAP_TILES; x++) {
+      seed = seed * 1664525u + 1013904223u;
+      if ((seed >> 8) % 5 != 0) Tilemap_SetTile(map, x, y, (uint16_t)(1 + (seed >> 16) % tile_count));
+    }
+  }
+
+  // Small enough that panning evicts.
+  size_t chunk_bytes = (size_t)TILEMAP_CHUNK_TILES * TILEMAP_BENCH_TILE_SIZE * TILEMAP_CHUNK_TILES * TILEMAP_BENCH_TILE_SIZE * 4;
+  Tilemap_SetCacheLimit(map, TILEMAP_BENCH_CACHE_CHUNKS * chunk_bytes);
+
+  LOGGER_INFO("Tilemap benchmark: %dx%d tiles of %d px, %dx%d view, %d frames, cache of %d chunks\n",
+    TILEMAP_BENCH_MAP_TILES, TILEMAP_BENCH_MAP_TILES, TILEMAP_BENCH_TILE_SIZE,
+    TILEMAP_BENCH_WIDTH, TILEMAP_BENCH_HEIGHT, TILEMAP_BENCH_FRAMES, TILEMAP_BENCH_CACHE_CHUNKS);
+
+  int tile_pixels = TILEMAP_BENCH_TILE_SIZE;
+  long drawn = 0, rebuilt = 0, evicted = 0;
+  uint64_t start = SDL_GetPerformanceCounter();
+
+  for (int frame = 0; frame < TILEMAP_BENCH_FRAMES; frame++) {
+    // Pans diagonally, faster across than down.
+    SDL_Rect camera = { frame * 12, frame * 5, TILEMAP_BENCH_WIDTH, TILEMAP_BENCH_HEIGHT };
+
+    for (int i = 0; i < TILEMAP_BENCH_EDITS; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      int x = (camera.x + (int)((seed >> 4) % TILEMAP_BENCH_WIDTH)) / tile_pixels;
+      int y = (camera.y + (int)((seed >> 16) % TILEMAP_BENCH_HEIGHT)) / tile_pixels;
+      Tilemap_SetTile(map, x, y, (uint16_t)(1 + (seed >> 24) % tile_count));
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    Tilemap_Draw(map, renderer, &camera);
+    SDL_RenderFlush(renderer);
+
+    Tilemap_FrameStats stats = Tilemap_GetFrameStats(map);
+    drawn += stats.chunks_drawn;
+    rebuilt += stats.chunks_rebuilt;
+    evicted += stats.chunks_evicted;
+
+    if (frame % TILEMAP_BENCH_REPORT_EVERY == 0) {
+      LOGGER_INFO("Tilemap frame %3d at %4d,%4d: %2d drawn, %2d rebuilt, %2d evicted, %2d cached (%.1f MB)\n",
+        frame, camera.x, camera.y, stats.chunks_drawn, stats.chunks_rebuilt, stats.chunks_evicted,
+        stats.chunks_cached, (double)stats.cache_bytes / (1024.0 * 1024.0));
+    }
+  }
+
+  double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+  LOGGER_INFO("Tilemap: %.3f ms/frame; per frame %.1f chunks drawn, %.2f rebuilt, %.2f evicted\n",
+    seconds * 1000.0 / TILEMAP_BENCH_FRAMES, (double)drawn / TILEMAP_BENCH_FRAMES,
+    (double)rebuilt / TILEMAP_BENCH_FRAMES, (double)evicted / TILEMAP_BENCH_FRAMES);
+
+  Tilemap_Destroy(map);
+  SDL_DestroyTexture(tileset);
+  SDL_DestroyRenderer(renderer);
+  SDL_FreeSurface(fb);
+}
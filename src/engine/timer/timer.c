@@ -0,0 +1,359 @@
+#include <engine/timer/timer.h>
+#include <engine/logger.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+#define TIMER_LEVELS 4
+#define TIMER_SLOT_BITS 8
+#define TIMER_SLOTS (1 << TIMER_SLOT_BITS)
+#define TIMER_SLOT_MASK (TIMER_SLOTS - 1)
+#define TIMER_MAX_DELTA ((UINT64_C(1) << (TIMER_LEVELS * TIMER_SLOT_BITS)) - 1)
+#define TIMER_NIL -1
+
+typedef enum {
+  TIMER_STATE_FREE,
+  TIMER_STATE_PENDING,
+  TIMER_STATE_FIRING,
+  TIMER_STATE_CANCELLED // Cancelled from inside its own callback
+} Timer_State;
+
+typedef struct {
+  uint64_t expires;
+  uint64_t period;
+  Timer_Callback callback;
+  void* data;
+  uint32_t generation;
+  Timer_State state;
+  int list; // Slot list the node is linked into
+  int prev;
+  int next;
+} Timer_Node;
+
+struct Timer_Wheel {
+  uint64_t now; // Last tick processed
+
+  int heads[TIMER_LEVELS * TIMER_SLOTS];
+  int level_counts[TIMER_LEVELS];
+
+  Timer_Node* nodes;
+  int node_capacity;
+  int free_head;
+  int pending;
+};
+
+static inline Timer_Handle internal_timer_handle(const Timer_Wheel* wheel, int index) {
+  return ((uint64_t)wheel->nodes[index].generation << 32) | (uint64_t)(index + 1);
+}
+
+static inline int internal_timer_level(int list) {
+  return list / TIMER_SLOTS;
+}
+
+static void internal_timer_link(Timer_Wheel* wheel, int index) {
+  Timer_Node* node = &wheel->nodes[index];
+  uint64_t delta = node->expires > wheel->now ? node->expires - wheel->now : 0;
+  uint64_t expires = node->expires;
+
+  // Beyond the top level's reach, park the timer as far out as it can go;
+  // cascading re-files it until it is really due.
+  if (delta > TIMER_MAX_DELTA) {
+    delta = TIMER_MAX_DELTA;
+    expires = wheel->now + TIMER_MAX_DELTA;
+  }
+
+  int level = 0;
+  while (level < TIMER_LEVELS - 1 && delta >= (UINT64_C(1) << ((level + 1) * TIMER_SLOT_BITS))) level++;
+
+  int list = level * TIMER_SLOTS + (int)((expires >> (level * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK);
+
+  node->list = list;
+  node->prev = TIMER_NIL;
+  node->next = wheel->heads[list];
+  if (wheel->heads[list] != TIMER_NIL) wheel->nodes[wheel->heads[list]].prev = index;
+  wheel->heads[list] = index;
+  wheel->level_counts[level]++;
+}
+
+static void internal_timer_unlink(Timer_Wheel* wheel, int index) {
+  Timer_Node* node = &wheel->nodes[index];
+
+  if (node->prev != TIMER_NIL) wheel->nodes[node->prev].next = node->next;
+  else wheel->heads[node->list] = node->next;
+  if (node->next != TIMER_NIL) wheel->nodes[node->next].prev = node->prev;
+
+  wheel->level_counts[internal_timer_level(node->list)]--;
+  node->prev = TIMER_NIL;
+  node->next = TIMER_NIL;
+}
+
+static void internal_timer_release(Timer_Wheel* wheel, int index) {
+  Timer_Node* node = &wheel->nodes[index];
+
+  node->state = TIMER_STATE_FREE;
+  node->generation++;
+  node->next = wheel->free_head;
+  wheel->free_head = index;
+}
+
+static bool internal_timer_grow(Timer_Wheel* wheel) {
+  int capacity = wheel->node_capacity ? wheel->node_capacity * 2 : 1024;
+  Timer_Node* nodes = realloc(wheel->nodes, (size_t)capacity * sizeof(Timer_Node));
+  if (!nodes) {
+    LOGGER_ERROR("Failed to grow timer pool to %d timers\n", capacity);
+    return false;
+  }
+
+  for (int i = capacity - 1; i >= wheel->node_capacity; i--) {
+    nodes[i] = (Timer_Node){ .state = TIMER_STATE_FREE, .generation = 1, .next = wheel->free_head };
+    wheel->free_head = i;
+  }
+
+  wheel->nodes = nodes;
+  wheel->node_capacity = capacity;
+  return true;
+}
+
+Timer_Wheel* Timer_CreateWheel(int capacity_hint) {
+  Timer_Wheel* wheel = calloc(1, sizeof(Timer_Wheel));
+  if (!wheel) return NULL;
+
+  for (int i = 0; i < TIMER_LEVELS * TIMER_SLOTS; i++) wheel->heads[i] = TIMER_NIL;
+  wheel->free_head = TIMER_NIL;
+
+  while (wheel->node_capacity < capacity_hint) {
+    if (!internal_timer_grow(wheel)) {
+      Timer_DestroyWheel(wheel);
+      return NULL;
+    }
+  }
+
+  return wheel;
+}
+
+void Timer_DestroyWheel(Timer_Wheel* wheel) {
+  if (!wheel) return;
+
+  free(wheel->nodes);
+  free(wheel);
+}
+
+Timer_Handle Timer_Schedule(Timer_Wheel* wheel, uint64_t delay_ms, uint64_t period_ms, Timer_Callback callback, void* data) {
+  if (!wheel || !callback) return 0;
+  if (wheel->free_head == TIMER_NIL && !internal_timer_grow(wheel)) return 0;
+
+  int index = wheel->free_head;
+  Timer_Node* node = &wheel->nodes[index];
+  wheel->free_head = node->next;
+
+  node->expires = wheel->now + (delay_ms > 0 ? delay_ms : 1);
+  node->period = period_ms;
+  node->callback = callback;
+  node->data = data;
+  node->state = TIMER_STATE_PENDING;
+
+  internal_timer_link(wheel, index);
+  wheel->pending++;
+
+  return internal_timer_handle(wheel, index);
+}
+
+bool Timer_Cancel(Timer_Wheel* wheel, Timer_Handle handle) {
+  if (!wheel || handle == 0) return false;
+
+  uint64_t slot = handle & 0xFFFFFFFFu;
+  if (slot == 0 || slot > (uint64_t)wheel->node_capacity) return false;
+
+  int index = (int)slot - 1;
+  Timer_Node* node = &wheel->nodes[index];
+  if (node->generation != (uint32_t)(handle >> 32)) return false;
+
+  switch (node->state) {
+    case TIMER_STATE_PENDING:
+      internal_timer_unlink(wheel, index);
+      internal_timer_release(wheel, index);
+      wheel->pending--;
+      return true;
+    case TIMER_STATE_FIRING:
+      // Released once its callback returns.
+      node->state = TIMER_STATE_CANCELLED;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Re-files every timer of one higher-level slot into lower levels and
+// returns the slot index, so the caller knows whether to cascade further up.
+static int internal_timer_cascade(Timer_Wheel* wheel, int level) {
+  int slot = (int)((wheel->now >> (level * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK);
+  int list = level * TIMER_SLOTS + slot;
+  int index = wheel->heads[list];
+
+  wheel->heads[list] = TIMER_NIL;
+  while (index != TIMER_NIL) {
+    int next = wheel->nodes[index].next;
+    wheel->level_counts[level]--;
+    internal_timer_link(wheel, index);
+    index = next;
+  }
+
+  return slot;
+}
+
+static void internal_timer_fire(Timer_Wheel* wheel, int index) {
+  internal_timer_unlink(wheel, index);
+  wheel->nodes[index].state = TIMER_STATE_FIRING;
+
+  Timer_Callback callback = wheel->nodes[index].callback;
+  callback(wheel->nodes[index].data);
+
+  // The callback may have scheduled timers and grown the pool: re-fetch.
+  Timer_Node* node = &wheel->nodes[index];
+  if (node->state == TIMER_STATE_FIRING && node->period > 0) {
+    node->state = TIMER_STATE_PENDING;
+    node->expires = wheel->now + node->period;
+    internal_timer_link(wheel, index);
+    return;
+  }
+
+  internal_timer_release(wheel, index);
+  wheel->pending--;
+}
+
+void Timer_Advance(Timer_Wheel* wheel, uint64_t elapsed_ms) {
+  if (!wheel) return;
+
+  uint64_t target = wheel->now + elapsed_ms;
+
+  while (wheel->now < target) {
+    // Nothing pending at all: jump straight to the target.
+    if (wheel->pending == 0) {
+      wheel->now = target;
+      break;
+    }
+
+    // Skip the ticks on which nothing fires or cascades, so long idle
+    // stretches cost a handful of iterations instead of one per millisecond.
+    wheel->now += Timer_NextDueIn(wheel, target - wheel->now);
+
+    if ((wheel->now & TIMER_SLOT_MASK) == 0) {
+      for (int level = 1; level < TIMER_LEVELS; level++) {
+        if (internal_timer_cascade(wheel, level) != 0) break;
+      }
+    }
+
+    // Timers scheduled by callbacks always land on a later tick, so this
+    // drains even when callbacks keep rescheduling.
+    int list = (int)(wheel->now & TIMER_SLOT_MASK);
+    while (wheel->heads[list] != TIMER_NIL) {
+      internal_timer_fire(wheel, wheel->heads[list]);
+    }
+  }
+}
+
+uint64_t Timer_GetTime(const Timer_Wheel* wheel) {
+  return wheel ? wheel->now : 0;
+}
+
+int Timer_GetPendingCount(const Timer_Wheel* wheel) {
+  return wheel ? wheel->pending : 0;
+}
+
+uint64_t Timer_NextDueIn(const Timer_Wheel* wheel, uint64_t max_ms) {
+  if (!wheel || wheel->pending == 0) return max_ms;
+
+  uint64_t due = max_ms;
+
+  // Level 0 holds exactly the timers due within the next rotation.
+  if (wheel->level_counts[0] > 0) {
+    for (uint64_t d = 1; d < TIMER_SLOTS && d < due; d++) {
+      if (wheel->heads[(wheel->now + d) & TIMER_SLOT_MASK] != TIMER_NIL) {
+        due = d;
+        break;
+      }
+    }
+  }
+
+  // Higher levels fire no earlier than their next cascade, which happens on
+  // a multiple of the lowest occupied level's span.
+  for (int level = 1; level < TIMER_LEVELS; level++) {
+    if (wheel->level_counts[level] == 0) continue;
+
+    uint64_t span = UINT64_C(1) << (level * TIMER_SLOT_BITS);
+    uint64_t to_cascade = span - (wheel->now & (span - 1));
+    if (to_cascade < due) due = to_cascade;
+    break;
+  }
+
+  return due;
+}
+
+
+/* ---- Benchmark ---- */
+
+#define TIMER_BENCH_COUNT 1000000
+#define TIMER_BENCH_MAX_DELAY_MS (10u * 60u * 1000u)
+#define TIMER_BENCH_FRAMES 600
+#define TIMER_BENCH_FRAME_MS 16
+
+static void internal_timer_bench_callback(void* data) {
+  (*(uint64_t*)data)++;
+}
+
+static double internal_timer_bench_ns(uint64_t start) {
+  return (double)(SDL_GetPerformanceCounter() - start) * 1.0e9 / SDL_GetPerformanceFrequency();
+}
+
+void Timer_Benchmark(void) {
+  Timer_Wheel* wheel = Timer_CreateWheel(TIMER_BENCH_COUNT);
+  Timer_Handle* handles = malloc(TIMER_BENCH_COUNT * sizeof(Timer_Handle));
+  if (!wheel || !handles) {
+    LOGGER_ERROR("Failed to allocate timer benchmark resources\n");
+    free(handles);
+    Timer_DestroyWheel(wheel);
+    return;
+  }
+
+  uint64_t fired = 0;
+  uint32_t seed = 0xBADC0DEu;
+
+  uint64_t start = SDL_GetPerformanceCounter();
+  for (int i = 0; i < TIMER_BENCH_COUNT; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    handles[i] = Timer_Schedule(wheel, seed % TIMER_BENCH_MAX_DELAY_MS, 0, internal_timer_bench_callback, &fired);
+  }
+  double insert_ns = internal_timer_bench_ns(start) / TIMER_BENCH_COUNT;
+
+  start = SDL_GetPerformanceCounter();
+  int cancelled = 0;
+  for (int i = 0; i < TIMER_BENCH_COUNT; i += 2) {
+    cancelled += Timer_Cancel(wheel, handles[i]) ? 1 : 0;
+  }
+  double cancel_ns = internal_timer_bench_ns(start) / cancelled;
+
+  int pending = Timer_GetPendingCount(wheel);
+  start = SDL_GetPerformanceCounter();
+  for (int frame = 0; frame < TIMER_BENCH_FRAMES; frame++) {
+    Timer_Advance(wheel, TIMER_BENCH_FRAME_MS);
+  }
+  double frame_us = internal_timer_bench_ns(start) / 1000.0 / TIMER_BENCH_FRAMES;
+
+  start = SDL_GetPerformanceCounter();
+  Timer_Advance(wheel, TIMER_BENCH_MAX_DELAY_MS);
+  double drain_ms = internal_timer_bench_ns(start) / 1.0e6;
+
+  LOGGER_INFO("Timer benchmark: %d timers over %u s\n", TIMER_BENCH_COUNT, TIMER_BENCH_MAX_DELAY_MS / 1000u);
+  LOGGER_INFO("Timer schedule: %.1f ns/timer\n", insert_ns);
+  LOGGER_INFO("Timer cancel  : %.1f ns/timer (%d cancelled)\n", cancel_ns, cancelled);
+  LOGGER_INFO("Timer advance : %.2f us/frame with %d pending (%d ms frames)\n", frame_us, pending, TIMER_BENCH_FRAME_MS);
+  LOGGER_INFO("Timer drain   : %.3f ms for the rest, %llu fired, %d left\n",
+    drain_ms, (unsigned long long)fired, Timer_GetPendingCount(wheel));
+
+  free(handles);
+  Timer_DestroyWheel(wheel);
+}
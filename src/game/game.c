@@ -2,17 +2,66 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <time.h>
+#include <math.h>
 #include <SDL2/SDL.h>
 
 #include <game/game.h>
 #include <engine/logger.h>
+#include <engine/metrics/metrics.h>
+#include <engine/profiler/profiler.h>
 #include <utils/utilities.h>
 
+#define GAME_IDLE_WAIT_MS 250
+#define GAME_STATS_INTERVAL_MS 5000
+#define GAME_WORLD_CELL_SIZE 128.0f
+#define GAME_OVERLAY_KEY SDL_SCANCODE_F3
 
 struct Game {
     bool running;
     SDL_Window* window;
     SDL_Renderer* renderer;
+
+    Game_RenderMode render_mode;
+    bool redraw_requested;
+    int active_animations;
+
+    Spatial_Index* world;
+    Spatial_Results visible;
+    Game_Camera camera;
+    Game_DrawFunction draw;
+    void* draw_user;
+    Tilemap* tilemap;
+
+    Timer_Wheel* game_timers;
+    Timer_Wheel* real_timers;
+    double time_scale;
+    bool paused;
+    uint64_t timers_last;
+    double game_carry_ms;
+    double real_carry_ms;
+
+    Coro_Scheduler* coroutines;
+    Audio_Mixer* audio;
+    Input_State* input;
+    Overlay* overlay;
+
+    Profiler_Zone* input_zone;
+    Profiler_Zone* timers_zone;
+    Profiler_Zone* coroutines_zone;
+    Profiler_Zone* audio_zone;
+    Profiler_Zone* cull_zone;
+    Profiler_Zone* present_zone;
+
+    Metrics_Counter* frames_metric;
+    Metrics_Counter* wakeups_metric;
+    Metrics_Histogram* frame_time_metric;
+
+    uint64_t stats_window_start;
+    clock_t stats_cpu_start;
+    uint64_t stats_wakeups;
+    uint64_t stats_frames;
+    Game_LoopStats loop_stats;
 };
 
 static Game* Game_Create() {
@@ -23,9 +72,60 @@ static Game* Game_Create() {
     game->window = NULL;
     game->renderer = NULL;
 
+    game->render_mode = GAME_RENDER_CONTINUOUS;
+    game->redraw_requested = true;
+    game->active_animations = 0;
+
+    game->world = NULL;
+    game->visible = (Spatial_Results){0};
+    game->camera = (Game_Camera){ 0.0f, 0.0f, 1.0f };
+    game->draw = NULL;
+    game->draw_user = NULL;
+    game->tilemap = NULL;
+
+    game->game_timers = NULL;
+    game->real_timers = NULL;
+    game->time_scale = 1.0;
+    game->paused = false;
+    game->timers_last = 0;
+    game->game_carry_ms = 0.0;
+    game->real_carry_ms = 0.0;
+
+    game->coroutines = NULL;
+    game->audio = NULL;
+    game->input = NULL;
+    game->overlay = NULL;
+
+    game->input_zone = Profiler_RegisterZone("input");
+    game->timers_zone = Profiler_RegisterZone("timers");
+    game->coroutines_zone = Profiler_RegisterZone("coroutines");
+    game->audio_zone = Profiler_RegisterZone("audio");
+    game->cull_zone = Profiler_RegisterZone("cull");
+    game->present_zone = Profiler_RegisterZone("present");
+
+    static const double frame_time_bounds[] = { 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 50.0, 100.0, 250.0 };
+    game->frames_metric = Metrics_RegisterCounter("game_frames_total");
+    game->wakeups_metric = Metrics_RegisterCounter("game_wakeups_total");
+    game->frame_time_metric = Metrics_RegisterHistogram("game_frame_time_ms", frame_time_bounds,
+        (int)(sizeof(frame_time_bounds) / sizeof(frame_time_bounds[0])));
+
+    game->stats_window_start = 0;
+    game->stats_cpu_start = 0;
+    game->stats_wakeups = 0;
+    game->stats_frames = 0;
+    game->loop_stats = (Game_LoopStats){0};
+
     return game;
 }
 
+// One teardown for every failure in Game_Init: whatever was created so far
+// is released and the caller's pointer cleared.
+static Game* Game_InitFailed(Game** game) {
+    Game_Destroy(*game);
+    *game = NULL;
+    return NULL;
+}
+
 Game* Game_Init(Game** game) {
   LOGGER_INFO("Initializing game...\n");
     if (*game == NULL) {
@@ -39,15 +139,14 @@ Game* Game_Init(Game** game) {
         SDL_INIT_EVENTS
         ) != 0) {
         LOGGER_ERROR("SDL_Init Error: %s\n", SDL_GetError());
-        return NULL;
+        return Game_InitFailed(game);
     }
 
     if ((*game)->window == NULL) {
         (*game)->window = SDL_CreateWindow("SDL2 Window", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 480, SDL_WINDOW_SHOWN);
         if (!(*game)->window) {
             LOGGER_ERROR("SDL_CreateWindow Error: %s\n", SDL_GetError());
-            SDL_Quit();
-            return NULL;
+            return Game_InitFailed(game);
         }
     }
 
@@ -55,12 +154,57 @@ Game* Game_Init(Game** game) {
         (*game)->renderer = SDL_CreateRenderer((*game)->window, -1, 0);
         if (!(*game)->renderer) {
             LOGGER_ERROR("SDL_CreateRenderer Error: %s\n", SDL_GetError());
-            SDL_DestroyWindow((*game)->window);
-            SDL_Quit();
-            return NULL;
+            return Game_InitFailed(game);
         }
     }
     
+    if ((*game)->world == NULL) {
+        (*game)->world = Spatial_Create(GAME_WORLD_CELL_SIZE, 1024);
+        if (!(*game)->world) {
+            LOGGER_ERROR("Failed to create world spatial index\n");
+            return Game_InitFailed(game);
+        }
+    }
+
+    if ((*game)->game_timers == NULL) (*game)->game_timers = Timer_CreateWheel(256);
+    if ((*game)->real_timers == NULL) (*game)->real_timers = Timer_CreateWheel(64);
+    if (!(*game)->game_timers || !(*game)->real_timers) {
+        LOGGER_ERROR("Failed to create timer wheels\n");
+        return Game_InitFailed(game);
+    }
+
+    if ((*game)->coroutines == NULL) {
+        (*game)->coroutines = Coro_CreateScheduler(0);
+        if (!(*game)->coroutines) {
+            LOGGER_ERROR("Failed to create coroutine scheduler\n");
+            return Game_InitFailed(game);
+        }
+    }
+
+    if ((*game)->input == NULL) {
+        (*game)->input = Input_Create();
+        if (!(*game)->input) {
+            LOGGER_ERROR("Failed to create input state\n");
+            return Game_InitFailed(game);
+        }
+    }
+
+    // The overlay is a debug aid; the game runs without it.
+    if ((*game)->overlay == NULL) {
+        (*game)->overlay = Overlay_Create((*game)->renderer);
+        if (!(*game)->overlay) LOGGER_WARN("Failed to create debug overlay\n");
+    }
+
+    // A missing sound device should not keep the game from starting.
+    if ((*game)->audio == NULL) {
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+            LOGGER_WARN("SDL audio unavailable, running without sound: %s\n", SDL_GetError());
+        } else {
+            (*game)->audio = Audio_Create(NULL);
+            if (!(*game)->audio) LOGGER_WARN("Failed to open audio device, running without sound\n");
+        }
+    }
+
     LOGGER_INFO("Game initialized.\n");
     return *game;
 }
@@ -69,6 +213,16 @@ void Game_Destroy(Game* game) {
     LOGGER_INFO("Destroying game...\n");
     if (!game) return;
 
+    Audio_Destroy(game->audio);
+    Input_Destroy(game->input);
+    Overlay_Destroy(game->overlay);
+    Spatial_FreeResults(&game->visible);
+    Spatial_Destroy(game->world);
+    // Before the wheels, since parked coroutines cancel their timers.
+    Coro_DestroyScheduler(game->coroutines);
+    Timer_DestroyWheel(game->game_timers);
+    Timer_DestroyWheel(game->real_timers);
+
     if (game->renderer) SDL_DestroyRenderer(game->renderer);
     if (game->window) SDL_DestroyWindow(game->window);
 
@@ -76,18 +230,293 @@ void Game_Destroy(Game* game) {
     SDL_Quit();
 }
 
+void Game_SetRenderMode(Game* game, Game_RenderMode mode) {
+    if (!game) return;
+
+    game->render_mode = mode;
+    game->redraw_requested = true;
+    LOGGER_INFO("Render mode set to %s\n", mode == GAME_RENDER_ON_DEMAND ? "on-demand" : "continuous");
+}
+
+void Game_RequestRedraw(Game* game) {
+    if (game) game->redraw_requested = true;
+}
+
+void Game_BeginAnimation(Game* game) {
+    if (game) game->active_animations++;
+}
+
+void Game_EndAnimation(Game* game) {
+    if (!game) return;
+
+    if (game->active_animations > 0) {
+        game->active_animations--;
+    } else {
+        LOGGER_WARN("Game_EndAnimation called without a matching Game_BeginAnimation\n");
+    }
+    // Present the settled frame once the last animation stops.
+    game->redraw_requested = true;
+}
+
+Game_LoopStats Game_GetLoopStats(const Game* game) {
+    return game ? game->loop_stats : (Game_LoopStats){0};
+}
+
+Spatial_Index* Game_GetWorld(Game* game) {
+    return game ? game->world : NULL;
+}
+
+void Game_SetDrawFunction(Game* game, Game_DrawFunction draw, void* user) {
+    if (!game) return;
+
+    game->draw = draw;
+    game->draw_user = user;
+    game->redraw_requested = true;
+}
+
+void Game_SetCamera(Game* game, Game_Camera camera) {
+    if (!game) return;
+
+    if (camera.zoom <= 0.0f) {
+        LOGGER_WARN("Camera zoom %.3f must be positive, using 1\n", camera.zoom);
+        camera.zoom = 1.0f;
+    }
+    game->camera = camera;
+    game->redraw_requested = true;
+}
+
+void Game_SetTilemap(Game* game, Tilemap* map) {
+    if (!game) return;
+
+    game->tilemap = map;
+    game->redraw_requested = true;
+}
+
+Game_Camera Game_GetCamera(const Game* game) {
+    return game ? game->camera : (Game_Camera){ 0.0f, 0.0f, 1.0f };
+}
+
+SDL_FRect Game_GetView(const Game* game) {
+    int width = 0, height = 0;
+    if (game && game->renderer) SDL_GetRendererOutputSize(game->renderer, &width, &height);
+
+    Game_Camera camera = Game_GetCamera(game);
+    return (SDL_FRect){ camera.x, camera.y, (float)width / camera.zoom, (float)height / camera.zoom };
+}
+
+const int* Game_GetVisible(const Game* game, int* count_out) {
+    *count_out = game ? game->visible.count : 0;
+    return game ? game->visible.ids : NULL;
+}
+
+Timer_Wheel* Game_GetTimers(Game* game, Game_Clock clock) {
+    if (!game) return NULL;
+    return clock == GAME_CLOCK_REAL ? game->real_timers : game->game_timers;
+}
+
+void Game_SetTimeScale(Game* game, double scale) {
+    if (!game) return;
+
+    if (scale < 0.0) {
+        LOGGER_WARN("Negative time scale %.3f clamped to 0\n", scale);
+        scale = 0.0;
+    }
+    game->time_scale = scale;
+}
+
+void Game_SetPaused(Game* game, bool paused) {
+    if (game) game->paused = paused;
+}
+
+Coro_Scheduler* Game_GetCoroutines(Game* game) {
+    return game ? game->coroutines : NULL;
+}
+
+Audio_Mixer* Game_GetAudio(Game* game) {
+    return game ? game->audio : NULL;
+}
+
+const Input_Snapshot* Game_GetInput(const Game* game) {
+    return game ? Input_GetSnapshot(game->input) : NULL;
+}
+
+Overlay* Game_GetOverlay(Game* game) {
+    return game ? game->overlay : NULL;
+}
+
+// Feeds the wall time since the last call into both wheels, carrying the
+// sub-millisecond remainder so scaled time does not drift.
+static void Game_AdvanceTimers(Game* game) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    double elapsed_ms = (double)(now - game->timers_last) * 1000.0 / SDL_GetPerformanceFrequency();
+    game->timers_last = now;
+
+    game->real_carry_ms += elapsed_ms;
+    uint64_t real_ms = (uint64_t)game->real_carry_ms;
+    game->real_carry_ms -= (double)real_ms;
+    Timer_Advance(game->real_timers, real_ms);
+
+    if (game->paused) return;
+
+    game->game_carry_ms += elapsed_ms * game->time_scale;
+    uint64_t game_ms = (uint64_t)game->game_carry_ms;
+    game->game_carry_ms -= (double)game_ms;
+    Timer_Advance(game->game_timers, game_ms);
+}
+
+// How long the idle wait may block without making a timer fire late.
+static int Game_IdleTimeout(const Game* game) {
+    double wait_ms = (double)Timer_NextDueIn(game->real_timers, GAME_IDLE_WAIT_MS) - game->real_carry_ms;
+
+    if (!game->paused && game->time_scale > 0.0) {
+        double game_ms = (double)Timer_NextDueIn(game->game_timers, GAME_IDLE_WAIT_MS) - game->game_carry_ms;
+        game_ms /= game->time_scale;
+        if (game_ms < wait_ms) wait_ms = game_ms;
+    }
+
+    int timeout = wait_ms > 0.0 ? (int)ceil(wait_ms) : 0;
+    return Coro_NextWakeIn(game->coroutines, timeout);
+}
+
+// Draws the tilemap, then culls the world against the camera and submits
+// the survivors. Returns the draw calls made.
+static int Game_DrawWorld(Game* game) {
+    SDL_FRect view = Game_GetView(game);
+    int draw_calls = 0;
+
+    // The map culls its own chunks; it works in whole world pixels, so the
+    // rect is widened to cover the partial ones at the edges.
+    if (game->tilemap) {
+        SDL_Rect camera = { (int)floorf(view.x), (int)floorf(view.y), (int)ceilf(view.w) + 1, (int)ceilf(view.h) + 1 };
+        SDL_RenderSetScale(game->renderer, game->camera.zoom, game->camera.zoom);
+        Tilemap_Draw(game->tilemap, game->renderer, &camera);
+        SDL_RenderSetScale(game->renderer, 1.0f, 1.0f);
+        draw_calls += Tilemap_GetFrameStats(game->tilemap).chunks_drawn;
+    }
+
+    if (!game->draw) return draw_calls;
+
+    uint64_t zone_start = Profiler_Begin();
+    Spatial_QueryRegions(game->world, &view, 1, &game->visible);
+    Profiler_End(game->cull_zone, zone_start);
+
+    return draw_calls + game->draw(game->renderer, &view, game->visible.ids, game->visible.count, game->draw_user);
+}
+
+static bool Game_NeedsFrame(const Game* game) {
+    return game->render_mode == GAME_RENDER_CONTINUOUS
+        || game->redraw_requested
+        || game->active_animations > 0
+        || Coro_WantsFrame(game->coroutines);
+}
+
+static void Game_ResetLoopStats(Game* game, uint64_t now) {
+    game->stats_window_start = now;
+    game->stats_cpu_start = clock();
+    game->stats_wakeups = 0;
+    game->stats_frames = 0;
+}
+
+static void Game_UpdateLoopStats(Game* game, bool force) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    double elapsed = (double)(now - game->stats_window_start) / SDL_GetPerformanceFrequency();
+
+    if (elapsed <= 0.0 || (!force && elapsed * 1000.0 < GAME_STATS_INTERVAL_MS)) return;
+
+    double cpu_seconds = (double)(clock() - game->stats_cpu_start) / CLOCKS_PER_SEC;
+
+    game->loop_stats.cpu_percent = cpu_seconds / elapsed * 100.0;
+    game->loop_stats.wakeups_per_second = game->stats_wakeups / elapsed;
+    game->loop_stats.frames_per_second = game->stats_frames / elapsed;
+
+    LOGGER_DEBUG("Loop: %.1f%% CPU, %.1f wakeups/s, %.1f frames/s\n",
+        game->loop_stats.cpu_percent, game->loop_stats.wakeups_per_second, game->loop_stats.frames_per_second);
+
+    Game_ResetLoopStats(game, now);
+}
+
 void Game_Run(Game* game) {
     TOTAL_PROFILED(Logger_RootLog, LOGGER_LEVEL_INFO, "ALL took %.3f ms. Starting game loop...\n");
-    SDL_Event event;
+    Game_ResetLoopStats(game, SDL_GetPerformanceCounter());
+    game->timers_last = SDL_GetPerformanceCounter();
 
     while (game->running) {
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) game->running = 0;
+        // Nothing to draw: block until an event arrives instead of spinning.
+        // Passing NULL leaves the event queued for Input_Poll below. The
+        // wait ends early when a timer is due.
+        if (!Game_NeedsFrame(game)) {
+            int timeout = Game_IdleTimeout(game);
+            if (timeout > 0) SDL_WaitEventTimeout(NULL, timeout);
         }
+        game->stats_wakeups++;
+        Metrics_CounterAdd(game->wakeups_metric, 1);
+        uint64_t frame_start = SDL_GetPerformanceCounter();
+
+        uint64_t zone_start = Profiler_Begin();
+        const Input_Snapshot* input = Input_Poll(game->input);
+        if (input->quit_requested) game->running = false;
+        if (input->window_changed) {
+            game->redraw_requested = true;
+            Tilemap_InvalidateAll(game->tilemap);
+        }
+        if (input->device_reset) {
+            Overlay_OnDeviceReset(game->overlay);
+            Tilemap_OnDeviceReset(game->tilemap);
+        }
+        if (Input_WasKeyPressed(input, GAME_OVERLAY_KEY)) {
+            Overlay_Toggle(game->overlay);
+            game->redraw_requested = true;
+        }
+        Profiler_End(game->input_zone, zone_start);
+
+        zone_start = Profiler_Begin();
+        Game_AdvanceTimers(game);
+        Profiler_End(game->timers_zone, zone_start);
+
+        zone_start = Profiler_Begin();
+        Coro_RunFrame(game->coroutines);
+        Profiler_End(game->coroutines_zone, zone_start);
+
+        zone_start = Profiler_Begin();
+        Audio_Update(game->audio);
+        Profiler_End(game->audio_zone, zone_start);
+
+        if (Game_NeedsFrame(game)) {
+            game->redraw_requested = false;
+
+            SDL_SetRenderDrawColor(game->renderer, 0, 0, 0, 255);
+            SDL_RenderClear(game->renderer);
+            int draw_calls = 1; // The clear
+            draw_calls += Game_DrawWorld(game);
+            draw_calls += Overlay_Draw(game->overlay);
+
+            zone_start = Profiler_Begin();
+            SDL_RenderPresent(game->renderer);
+            Profiler_End(game->present_zone, zone_start);
+
+            Input_MarkPresented(game->input);
+            game->stats_frames++;
+
+            double frame_ms = (double)(SDL_GetPerformanceCounter() - frame_start) * 1000.0 / SDL_GetPerformanceFrequency();
+            Metrics_CounterAdd(game->frames_metric, 1);
+            Metrics_HistogramObserve(game->frame_time_metric, frame_ms);
+            Overlay_RecordFrame(game->overlay, frame_ms, draw_calls);
+        }
+
+        // Every iteration closes a profiler frame, so idle wakeups never
+        // pile up into the next drawn frame.
+        Profiler_EndFrame();
+        Game_UpdateLoopStats(game, false);
+    }
+
+    Game_UpdateLoopStats(game, true);
+    LOGGER_INFO("Game loop stopped: %.1f%% CPU, %.1f wakeups/s, %.1f frames/s over the last window\n",
+        game->loop_stats.cpu_percent, game->loop_stats.wakeups_per_second, game->loop_stats.frames_per_second);
 
-        SDL_SetRenderDrawColor(game->renderer, 0, 0, 0, 255);
-        SDL_RenderClear(game->renderer);
-        SDL_RenderPresent(game->renderer);
+    Input_LatencyStats latency = Input_GetLatency(game->input);
+    if (latency.samples > 0) {
+        LOGGER_INFO("Input to present latency: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms over %d frames\n",
+            latency.p50_ms, latency.p95_ms, latency.p99_ms, latency.max_ms, latency.samples);
     }
 }
 
@@ -1,6 +1,16 @@
 #include <engine/constants.h>
 #include <utils/utilities.h>
 #include <engine/logger.h>
+#include <engine/jobs/jobs.h>
+#include <engine/metrics/metrics.h>
+#include <engine/raster/raster.h>
+#include <engine/particles/particles.h>
+#include <engine/spatial/spatial.h>
+#include <engine/timer/timer.h>
+#include <engine/coro/coro.h>
+#include <engine/audio/audio.h>
+#include <engine/savestate/savestate.h>
+#include <engine/tilemap/tilemap.h>
 #include <game/game.h>
 
 #include <stdio.h>
@@ -10,6 +20,24 @@
 
 #define COMMAND(name, return_type, ...) return_type name(int argc, char **argv, ##__VA_ARGS__)
 
+typedef struct {
+  const char *name;
+  void (*run)(void);
+} Benchmark;
+
+static const Benchmark BENCHMARKS[] = {
+  { "raster", Raster_Benchmark },
+  { "particles", Particles_Benchmark },
+  { "spatial", Spatial_Benchmark },
+  { "timer", Timer_Benchmark },
+  { "coro", Coro_Benchmark },
+  { "audio", Audio_Benchmark },
+  { "savestate", Savestate_Benchmark },
+  { "tilemap", Tilemap_Benchmark },
+};
+
+#define BENCHMARK_COUNT (int)(sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]))
+
 
 COMMAND(CMD_Help, bool) {
   bool command_hit = false;
@@ -21,6 +49,8 @@ COMMAND(CMD_Help, bool) {
   "Options:\n"
   "  -h, --help     Display this help message\n"
   "  -v, --version  Display the version information\n"
+  "  --on-demand    Only redraw when something changes (sleep when idle)\n"
+  "  --bench NAME   Run an engine benchmark (NAME or 'all')\n"
   "\n"
   "Written by JohnLesterDev, and built for x86_64-pc-linux-gnu\n"
   ;
@@ -55,6 +85,43 @@ COMMAND(CMD_Version, bool) {
   return command_hit;
 }
 
+// status_out receives the exit status when the command ran: nonzero for an
+// unknown benchmark, so scripted runs can tell.
+COMMAND(CMD_Bench, bool, int *status_out) {
+  bool command_hit = false;
+
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--bench") != 0) continue;
+
+    // A following flag such as --on-demand is not a benchmark name.
+    const char *name = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[i + 1] : "all";
+    bool found = false;
+    for (int b = 0; b < BENCHMARK_COUNT; b++) {
+      if (strcmp(name, "all") == 0 || strcmp(name, BENCHMARKS[b].name) == 0) {
+        LOGGER_INFO("Running benchmark: %s\n", BENCHMARKS[b].name);
+        BENCHMARKS[b].run();
+        found = true;
+      }
+    }
+
+    if (!found) LOGGER_ERROR("Unknown benchmark: %s\n", name);
+    *status_out = found ? 0 : -1;
+    command_hit = true;
+    Jobs_Destroy();
+    break;
+  }
+
+  return command_hit;
+}
+
+COMMAND(CMD_OnDemand, bool) {
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--on-demand") == 0) return true;
+  }
+
+  return false;
+}
+
 
 int main(int argc, char **argv) {
   VOID_PROFILED(false, Logger_RootLog, LOGGER_LEVEL_INFO, Constants_InitPaths);
@@ -63,7 +130,8 @@ int main(int argc, char **argv) {
     VOID_PROFILED(false, Logger_RootLog, LOGGER_LEVEL_INFO, Logger_Init, stdout, path_join(GAME_ROOT_PATH, ".log"), LOGGER_LEVEL_INFO, NULL);
   }
 
-  if (CMD_Help(argc, argv) || CMD_Version(argc, argv)) return 0;
+  int status = 0;
+  if (CMD_Help(argc, argv) || CMD_Version(argc, argv) || CMD_Bench(argc, argv, &status)) return status;
   
   Game *game = NULL;
 
@@ -72,8 +140,16 @@ int main(int argc, char **argv) {
     return -1;
   }
 
+  if (CMD_OnDemand(argc, argv)) Game_SetRenderMode(game, GAME_RENDER_ON_DEMAND);
+
+  char *metrics_path = path_join(GAME_ROOT_PATH, "metrics.sock");
+  Metrics_StartServer(metrics_path);
+  free(metrics_path);
+
   Game_Run(game);
+  Metrics_StopServer();
   Game_Destroy(game);
+  Jobs_Destroy();
   Constants_DestroyPaths();
   Logger_Destroy();
 